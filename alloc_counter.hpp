@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// alloc_counter.hpp
+//
+// Counts heap allocations by replacing the global operator new and
+// operator delete, including the aligned forms used for over-aligned types
+// since C++17.
+//
+// Because this replaces global operators, include it in exactly one
+// translation unit of a program, and only in measurement programs such as
+// gnomes_timing.cpp.
+//
+// How to use:
+//
+//    size_t before = AllocCounter::allocations();
+//    // run the code you want to check
+//    size_t made = AllocCounter::allocations() - before;
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+class AllocCounter {
+private:
+  static std::atomic<size_t>& _allocations() {
+    static std::atomic<size_t> count(0);
+    return count;
+  }
+  static std::atomic<size_t>& _bytes() {
+    static std::atomic<size_t> count(0);
+    return count;
+  }
+
+public:
+
+  // Record one allocation of the given size.
+  static void record(size_t bytes) {
+    _allocations().fetch_add(1, std::memory_order_relaxed);
+    _bytes().fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Return the number of allocations, and the total bytes requested by
+  // them, since the program started.
+  static size_t allocations() { return _allocations().load(std::memory_order_relaxed); }
+  static size_t bytes() { return _bytes().load(std::memory_order_relaxed); }
+};
+
+// operator new and operator delete are kept out of line so that the
+// compiler does not pair an inlined malloc with delete, or free with new.
+__attribute__((noinline))
+void* operator new(size_t size) {
+  AllocCounter::record(size);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline))
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+__attribute__((noinline))
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete[](void* p, size_t) noexcept {
+  std::free(p);
+}
+
+#ifdef __cpp_aligned_new
+
+// Allocations of over-aligned types. aligned_alloc needs a size that is a
+// multiple of the alignment.
+__attribute__((noinline))
+void* operator new(size_t size, std::align_val_t alignment) {
+  AllocCounter::record(size);
+  const size_t align = static_cast<size_t>(alignment),
+               rounded = ((size ? size : 1) + align - 1) / align * align;
+  if (void* p = std::aligned_alloc(align, rounded)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline))
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+__attribute__((noinline))
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete[](void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline))
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+#endif
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// arena.hpp
+//
+// Monotonic arena allocator for scratch memory that is thrown away all at
+// once.
+//
+// This class depends only on the C++11 STL.
+//
+// How to use:
+//
+//    Arena arena;
+//    for (...) {
+//      arena.reset();                          // forget earlier allocations
+//      int* table = arena.allocate<int>(n);    // uninitialized
+//      ...
+//    }
+//
+// Allocations are never freed one by one. reset() makes all of the memory
+// available again; if the previous round needed more than one block, the
+// blocks are merged into a single block big enough for that round, so a
+// repeated workload of the same size stops touching the heap after its
+// first round.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class Arena {
+private:
+  std::vector<std::unique_ptr<unsigned char[]>> _blocks;
+  std::vector<size_t> _block_sizes;
+  size_t _used, _total_used, _heap_allocations;
+
+  // Add a block of at least the given number of bytes.
+  void grow(size_t bytes) {
+    size_t size = std::max(bytes, _block_sizes.empty() ? size_t(4096) : (2 * _block_sizes.back()));
+    _blocks.emplace_back(new unsigned char[size]);
+    _block_sizes.push_back(size);
+    _used = 0;
+    ++_heap_allocations;
+  }
+
+public:
+
+  // Create an empty arena; the first allocation creates its first block.
+  Arena()
+  : _used(0), _total_used(0), _heap_allocations(0) { }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Return uninitialized space for count objects of type T, which must be
+  // trivially destructible since the arena never runs destructors.
+  template <typename T>
+  T* allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena cannot destroy objects");
+
+    const size_t bytes = count * sizeof(T);
+    for (;;) {
+      if (!_blocks.empty()) {
+        unsigned char* next = _blocks.back().get() + _used;
+        size_t padding = (alignof(T) - (reinterpret_cast<std::uintptr_t>(next) % alignof(T))) % alignof(T);
+        if ((_used + padding + bytes) <= _block_sizes.back()) {
+          _used += padding + bytes;
+          _total_used += padding + bytes;
+          return reinterpret_cast<T*>(next + padding);
+        }
+      }
+      grow(bytes + alignof(T));
+    }
+  }
+
+  // Make all memory available again, invalidating everything allocated so
+  // far.
+  void reset() {
+    if (_blocks.size() > 1) {
+      size_t size = 0;
+      for (auto block_size : _block_sizes) {
+        size += block_size;
+      }
+      _blocks.clear();
+      _block_sizes.clear();
+      grow(size);
+    }
+    _used = 0;
+    _total_used = 0;
+  }
+
+  // Return the bytes handed out since the last reset, and the number of
+  // blocks ever taken from the heap.
+  size_t used() const { return _total_used; }
+  size_t heap_allocations() const { return _heap_allocations; }
+};
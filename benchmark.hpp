@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.hpp
+//
+// Summary statistics for repeated timing trials, and least-squares fits of
+// how running time grows with input size.
+//
+// This file depends only on the C++11 STL.
+//
+// How to use:
+//
+//    Samples samples;
+//    for (int trial = 0; trial < 10; ++trial) {
+//      Timer timer;
+//      // run the code being measured
+//      samples.add(timer.elapsed());
+//    }
+//    std::cout << samples.median() << " " << samples.percentile(95) << std::endl;
+//
+//    // sizes[i] is an input size, seconds[i] its median time
+//    double exponent = growth_exponent(sizes, seconds); // time ~ n^exponent
+//    double base = growth_base(sizes, seconds);         // time ~ base^n
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+class Samples {
+private:
+  std::vector<double> _values;
+  bool _sorted;
+
+  // Sort the values, if they have changed since the last sort.
+  void sort() {
+    if (!_sorted) {
+      std::sort(_values.begin(), _values.end());
+      _sorted = true;
+    }
+  }
+
+public:
+
+  // Create an empty set of samples.
+  Samples()
+  : _sorted(true) { }
+
+  // Add one measurement.
+  void add(double value) {
+    _values.push_back(value);
+    _sorted = false;
+  }
+
+  // Return the number of measurements.
+  size_t size() const { return _values.size(); }
+
+  // Return the p-th percentile, 0 <= p <= 100, by the nearest-rank method,
+  // so it is always one of the measurements. There must be at least one.
+  double percentile(double p) {
+    assert(!_values.empty());
+    assert((p >= 0) && (p <= 100));
+    sort();
+    size_t rank = size_t(std::ceil((p / 100) * _values.size()));
+    return _values[std::max(rank, size_t(1)) - 1];
+  }
+
+  // Return the smallest measurement and the median. There must be at least
+  // one measurement.
+  double min() { return percentile(0); }
+  double median() { return percentile(50); }
+};
+
+// Return the slope of the least-squares line through the points (x[i],
+// y[i]). There must be at least two distinct x values.
+double least_squares_slope(const std::vector<double>& x, const std::vector<double>& y) {
+
+  assert(x.size() == y.size());
+  assert(x.size() >= 2);
+
+  double mean_x = 0, mean_y = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    mean_x += x[i];
+    mean_y += y[i];
+  }
+  mean_x /= x.size();
+  mean_y /= y.size();
+
+  double covariance = 0, variance = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    covariance += (x[i] - mean_x) * (y[i] - mean_y);
+    variance += (x[i] - mean_x) * (x[i] - mean_x);
+  }
+  assert(variance > 0);
+  return covariance / variance;
+}
+
+// Return k such that seconds grows like sizes^k, fit on a log-log scale.
+// Suits polynomial-time algorithms. Times must be positive.
+double growth_exponent(const std::vector<double>& sizes, const std::vector<double>& seconds) {
+  std::vector<double> log_sizes, log_seconds;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    log_sizes.push_back(std::log(sizes[i]));
+    log_seconds.push_back(std::log(seconds[i]));
+  }
+  return least_squares_slope(log_sizes, log_seconds);
+}
+
+// Return b such that seconds grows like b^sizes, fit on a semi-log scale.
+// Suits exponential-time algorithms. Times must be positive.
+double growth_base(const std::vector<double>& sizes, const std::vector<double>& seconds) {
+  std::vector<double> log_seconds;
+  for (double s : seconds) {
+    log_seconds.push_back(std::log(s));
+  }
+  return std::exp(least_squares_slope(sizes, log_seconds));
+}
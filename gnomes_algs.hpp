@@ -12,10 +12,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
 #include <vector>
 
+#include "arena.hpp"
+#include "gnomes_kernels.hpp"
 #include "gnomes_types.hpp"
+#include "thread_pool.hpp"
 
 
 
@@ -24,20 +34,328 @@
 
 namespace gnomes {
 
-  struct Path_Status {
-    path candidate_path; // Stores object of class "path"
-    bool is_None; // True if path does not exist; otherwise, false
+  // Counters of the work done inside the solvers, for profiling. Solvers
+  // only update them when GNOMES_ENABLE_STATS is defined before this file is
+  // included; otherwise every update compiles to nothing and the counters
+  // stay zero.
+  //
+  // Each thread has its own counters, so work done on ThreadPool workers is
+  // not seen by the calling thread.
+  struct solver_stats {
+#ifdef GNOMES_ENABLE_STATS
+    static const bool enabled = true;
+#else
+    static const bool enabled = false;
+#endif
+
+    // Exhaustive search: candidate bit strings tried, and those whose walk
+    // stopped early on rock or the grid's edge.
+    uint64_t candidates_generated = 0, candidates_pruned = 0;
+    // Cells stepped on by candidate walks, or scored by the dynamic
+    // programming algorithm; of the scored cells, those that are rock or
+    // cannot be reached; and cells the dynamic programming algorithm never
+    // looked at because they lie outside a live region.
+    uint64_t cells_visited = 0, cells_unreachable = 0, cells_skipped = 0;
+    // Paths built for results or copied out of a context.
+    uint64_t paths_copied = 0;
+    // Bytes of scratch memory requested by the solvers.
+    uint64_t bytes_allocated = 0;
+
+    // Return the calling thread's counters.
+    static solver_stats& current() {
+      static thread_local solver_stats stats;
+      return stats;
+    }
+
+    // Set every counter to zero.
+    void reset() {
+      *this = solver_stats();
+    }
+
+    // Print the counters on one line.
+    void print() const {
+      std::cout << "candidates_generated=" << candidates_generated
+                << " candidates_pruned=" << candidates_pruned
+                << " cells_visited=" << cells_visited
+                << " cells_unreachable=" << cells_unreachable
+                << " cells_skipped=" << cells_skipped
+                << " paths_copied=" << paths_copied
+                << " bytes_allocated=" << bytes_allocated << std::endl;
+    }
+  };
+
+  // Add amount to the calling thread's solver_stats counter, when stats are
+  // enabled. amount is not evaluated otherwise.
+#ifdef GNOMES_ENABLE_STATS
+#define GNOMES_STAT(counter, amount) \
+  (::gnomes::solver_stats::current().counter += (amount))
+#else
+#define GNOMES_STAT(counter, amount) ((void) 0)
+#endif
+
+  // Reusable state for solving many grids in a row. A context holds an arena
+  // for the solvers' scratch tables and the path they return, so once it has
+  // seen a grid of a given size, solving grids of that size again does not
+  // allocate any heap memory.
+  //
+  // A context must only be used by one thread at a time.
+  class solver_context {
+  private:
+    Arena memory_;
+    std::optional<path> result_;
+
+  public:
+
+    // Return the arena, emptied for a new solve.
+    Arena& fresh_memory() {
+      memory_.reset();
+      return memory_;
+    }
 
-    
-    Path_Status(const grid& setting)
-      :candidate_path(setting), is_None(true) {}
-    
-    // Path_Ptr(const grid& setting) {
-    //   candidate_path(setting);
-    // }
+    // Return the result path, emptied and set on the given grid. It is
+    // overwritten by the next solve with this context.
+    path& fresh_result(const grid& setting) {
+      if (result_) {
+        result_->reset(setting);
+      } else {
+        result_.emplace(setting);
+      }
+      return *result_;
+    }
+
+    // Accessor.
+    const Arena& memory() const { return memory_; }
+  };
 
+  // The cells that can lie on a best path: those that can be reached from
+  // (0, 0), and from which a gold cell can be reached (counting the cell
+  // itself). A best path collects its last gold on its last cell, so every
+  // cell of it is live, and so is every cell of any path leading to a live
+  // cell.
+  //
+  // For each row i, the live cells lie in columns [first[i], last[i]), the
+  // row's envelope. Rows from live_rows on have no live cells, and neither
+  // does any row when no gold can be reached; rows before live_rows all have
+  // some. An envelope may also hold dead cells between live ones.
+  struct live_region {
+    coordinate columns;
+    std::vector<coordinate> first, last;
+    coordinate live_rows;
+    // The largest row+column of a live cell, which is the most steps a best
+    // path can take.
+    size_t max_steps;
+    // The total number of cells in all envelopes.
+    size_t envelope_cells;
+
+    // Return true when no gold can be reached at all.
+    bool empty() const { return live_rows == 0; }
+
+    // Return the fraction of the grid's cells outside every envelope.
+    double skipped_fraction() const {
+      const size_t cells = first.size() * columns;
+      return cells ? (1.0 - (double(envelope_cells) / cells)) : 0.0;
+    }
   };
 
+  // Compute the live region of the given grid.
+  //
+  // A forward pass marks the cells reachable from (0, 0); in each row it
+  // starts at the first reachable column of the row above and stops at the
+  // first blocked cell past that row's last reachable column. A backward pass
+  // over the reachable cells then keeps those that can reach gold. The marks
+  // are one bit per cell, so the pre-pass reads each cell at most twice and
+  // only ever clears one bit per 64 cells of memory.
+  //
+  // The grid must be non-empty.
+  live_region find_live_region(const grid& setting) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+    const size_t words = (columns + 63) / 64;
+    std::vector<uint64_t> marked(rows * words, 0);
+    auto bit = [&](coordinate row, coordinate column) {
+      return (marked[(row * words) + (column / 64)] >> (column % 64)) & 1;
+    };
+    auto mark = [&](coordinate row, coordinate column) {
+      marked[(row * words) + (column / 64)] |= uint64_t(1) << (column % 64);
+    };
+    auto unmark = [&](coordinate row, coordinate column) {
+      marked[(row * words) + (column / 64)] &= ~(uint64_t(1) << (column % 64));
+    };
+
+    live_region live;
+    live.first.assign(rows, 0);
+    live.last.assign(rows, 0);
+    GNOMES_STAT(bytes_allocated, (marked.size() * sizeof(uint64_t)) +
+                                 (2 * rows * sizeof(coordinate)));
+    live.live_rows = 0;
+    live.max_steps = 0;
+    live.envelope_cells = 0;
+    live.columns = columns;
+
+    // Forward pass. The reachable cells of row i are recorded in
+    // [first[i], last[i]) for now; reached_rows counts the rows with any.
+    coordinate reached_rows = 0, above_first = 0, above_last = 1;
+    for (coordinate i = 0; i < rows; ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      coordinate first = columns, last = 0;
+      bool left = false;
+      for (coordinate j = above_first; j < columns; ++j) {
+        const bool above = (i == 0) ? (j == 0) : ((j < above_last) && bit(i - 1, j));
+        const bool here = (cells[j] != CELL_ROCK) && (left || above);
+        if (here) {
+          mark(i, j);
+          first = std::min(first, j);
+          last = j + 1;
+        } else if (j >= above_last) {
+          break;
+        }
+        left = here;
+      }
+      if (first == columns) {
+        break;
+      }
+      live.first[i] = above_first = first;
+      live.last[i] = above_last = last;
+      reached_rows = i + 1;
+    }
+
+    // Backward pass, turning each mark into a live mark in place: the cells
+    // to the right and below are already done.
+    for (coordinate i = reached_rows; i > 0; --i) {
+      const coordinate row = i - 1;
+      const cell_kind* cells = setting.row_begin(row);
+      coordinate first = columns, last = 0;
+      for (coordinate j = live.last[row]; j > live.first[row]; --j) {
+        const coordinate column = j - 1;
+        if (!bit(row, column)) {
+          continue;
+        }
+        if ((cells[column] == CELL_GOLD) ||
+            ((column + 1 < columns) && bit(row, column + 1)) ||
+            ((row + 1 < reached_rows) && bit(row + 1, column))) {
+          first = column;
+          last = std::max(last, column + 1);
+        } else {
+          unmark(row, column);
+        }
+      }
+      if (first == columns) {
+        live.first[row] = live.last[row] = 0;
+      } else {
+        live.first[row] = first;
+        live.last[row] = last;
+        live.live_rows = std::max(live.live_rows, i);
+        live.max_steps = std::max(live.max_steps, size_t(row + last - 1));
+        live.envelope_cells += last - first;
+      }
+    }
+
+    return live;
+  }
+
+  // Return the candidate path that the exhaustive search algorithm builds
+  // from the low len bits of bits. Bit k chooses step k+1: 1 for right, 0 for
+  // down. The path stops early, before the first step that would leave the
+  // grid or step on rock.
+  // The candidate is written into the given path, which is emptied first.
+  void exhaustive_candidate(const grid& setting, size_t len, uint64_t bits,
+                            path& candidate) {
+
+    candidate.reset(setting); // candidate solution with an empty path with only 1 step
+
+    for (size_t k = 0; k < len; k++) {
+
+      // Generates candidate solution using bitwise operation
+      auto dir = ((bits >> k) & 1) ? STEP_DIRECTION_RIGHT : STEP_DIRECTION_DOWN;
+      if (candidate.is_step_valid(dir)) {
+        candidate.add_step(dir);
+      }
+      else {
+        // Invalid move, invalid path
+        break;
+      }
+    }
+  }
+
+  // As above, returning a new path.
+  path exhaustive_candidate(const grid& setting, size_t len, uint64_t bits) {
+    path candidate(setting);
+    exhaustive_candidate(setting, len, bits, candidate);
+    return candidate;
+  }
+
+  // Return the gold on the same candidate path that exhaustive_candidate
+  // builds, by walking the grid directly. This allocates nothing, so the
+  // search loops use it and only build a path for the winner.
+  unsigned exhaustive_candidate_gold(const grid& setting, size_t len, uint64_t bits) {
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+    const cell_kind* cells = setting.row_begin(0);
+    coordinate row = 0, column = 0;
+    unsigned gold = 0;
+
+    size_t k = 0;
+    for (; k < len; k++) {
+      if ((bits >> k) & 1) {
+        if ((column + 1 == columns) || (cells[column + 1] == CELL_ROCK)) {
+          break;
+        }
+        ++column;
+      } else {
+        if ((row + 1 == rows) || (cells[columns + column] == CELL_ROCK)) {
+          break;
+        }
+        ++row;
+        cells += columns;
+      }
+      gold += (cells[column] == CELL_GOLD);
+    }
+
+    GNOMES_STAT(cells_visited, k);
+    GNOMES_STAT(candidates_pruned, k < len);
+    return gold;
+  }
+
+  // As above, but the walk also stops before leaving the envelopes of the
+  // given live region, as if the cells outside were rock. Only dead cells are
+  // cut off, and a walk that enters one collects no more gold, so the result
+  // is the same.
+  unsigned exhaustive_candidate_gold(const grid& setting, const live_region& live,
+                                     size_t len, uint64_t bits) {
+
+    const coordinate columns = setting.columns();
+    const cell_kind* cells = setting.row_begin(0);
+    coordinate row = 0, column = 0;
+    unsigned gold = 0;
+
+    size_t k = 0;
+    for (; k < len; k++) {
+      if ((bits >> k) & 1) {
+        if ((column + 1 == live.last[row]) || (cells[column + 1] == CELL_ROCK)) {
+          break;
+        }
+        ++column;
+      } else {
+        if ((row + 1 == live.live_rows) ||
+            (column < live.first[row + 1]) || (column >= live.last[row + 1]) ||
+            (cells[columns + column] == CELL_ROCK)) {
+          break;
+        }
+        ++row;
+        cells += columns;
+      }
+      gold += (cells[column] == CELL_GOLD);
+    }
+
+    GNOMES_STAT(cells_visited, k);
+    GNOMES_STAT(candidates_pruned, k < len);
+    return gold;
+  }
+
   // Solve the greedy gnomes problem for the given grid (which is called "setting"
   // in this case), using an exhaustive search algorithm.
   //
@@ -45,8 +363,14 @@ namespace gnomes {
   // width+height must be small enough to fit in a 64-bit int; this is enforced
   // with an assertion.
   //
+  // Candidates are tried by increasing length, then increasing bit string,
+  // and the first one with the most gold wins. The empty path wins when no
+  // gold is reachable.
+  //
+  // The result is held by the given context.
+  //
   // The grid must be non-empty.
-  path greedy_gnomes_exhaustive(const grid& setting) {
+  const path& greedy_gnomes_exhaustive(const grid& setting, solver_context& context) {
 
     // grid must be non-empty.
     assert(setting.rows() > 0);
@@ -56,136 +380,1433 @@ namespace gnomes {
     const size_t max_steps = setting.rows() + setting.columns() - 2;
     assert(max_steps < 64);
 
-    // TODO: implement the exhaustive search algorithm, then delete this
-    // comment.
-    path best(setting); // best = None
+    // best = None, which the empty path (length 0) stands in for
+    unsigned best_gold = 0;
+    size_t best_len = 0;
+    uint64_t best_bits = 0;
+
+    for (size_t len = 0; len <= max_steps; len++) {
+      GNOMES_STAT(candidates_generated, uint64_t(1) << len);
+      for (uint64_t bits = 0; bits < (uint64_t(1) << len); bits++) {
+
+        // if candidate stays inside the grid and never crosses a CELL_ROCK (X)
+        // (NOTE: this already got taken cared of by exhaustive_candidate_gold)
+        unsigned gold = exhaustive_candidate_gold(setting, len, bits);
+
+          // if candidate harvests more gold than best
+          if (gold > best_gold)  {
+                best_gold = gold;
+                best_len = len;
+                best_bits = bits;
+              }
+
+      } // End of 2nd for-loop
+    }
+
+    path& best = context.fresh_result(setting);
+    exhaustive_candidate(setting, best_len, best_bits, best);
+    GNOMES_STAT(paths_copied, 1);
+    return best;
+  }
+
+  // Solve the greedy gnomes problem for the given grid using the exhaustive
+  // search algorithm above, with a context of its own.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_exhaustive(const grid& setting) {
+    solver_context context;
+    GNOMES_STAT(paths_copied, 1);
+    return greedy_gnomes_exhaustive(setting, context);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with the exhaustive
+  // search algorithm, returning exactly the path that greedy_gnomes_exhaustive
+  // returns, after a find_live_region pre-pass. Candidates are only tried up
+  // to the live region's max_steps, since the winner ends on a live cell, and
+  // each walk stops at the edge of the live envelopes. Cutting one step off
+  // the longest candidates halves the work, and grids whose rocks wall off
+  // all but a corner may be searched even when rows+columns is 64 or more.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_exhaustive_live(const grid& setting) {
 
-    bool bit = 0; 
+    const live_region live = find_live_region(setting);
+    if (live.empty()) {
+      return path(setting);
+    }
 
-    //std::vector<size_t> stack(max_steps+1, 0); // allocate space for subset and initialize values to 0
+    const size_t max_steps = live.max_steps;
+    assert(max_steps < 64);
+
+    unsigned best_gold = 0;
+    size_t best_len = 0;
+    uint64_t best_bits = 0;
 
     for (size_t len = 0; len <= max_steps; len++) {
-      for (size_t bits = 0; bits <= (pow(2.0, len)-1); bits++) {
-        path candidate(setting); // candidate solution with an empty path with only 1 step
-
-        for (size_t k = 0; k <= len-1; k++) {
-
-          // Generates candidate solution using bitwise operation
-          bit = (bits >> k) & 1;
-          if (bit == 1) {
-            // Checks if step to right is valid
-            if (candidate.is_step_valid(STEP_DIRECTION_RIGHT)) {
-              // Moves to the right
-              candidate.add_step(STEP_DIRECTION_RIGHT);
-            }
-            else {
-              // Invalid move, invalid path
-              break;
+      GNOMES_STAT(candidates_generated, uint64_t(1) << len);
+      for (uint64_t bits = 0; bits < (uint64_t(1) << len); bits++) {
+        unsigned gold = exhaustive_candidate_gold(setting, live, len, bits);
+        if (gold > best_gold) {
+          best_gold = gold;
+          best_len = len;
+          best_bits = bits;
+        }
+      }
+    }
+
+    GNOMES_STAT(paths_copied, 1);
+    return exhaustive_candidate(setting, best_len, best_bits);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with the exhaustive
+  // search algorithm, returning exactly the path that greedy_gnomes_exhaustive
+  // returns, but re-walking only the part of each candidate that changed.
+  //
+  // For each length, candidates are visited in order of a counter whose bits
+  // are reversed into the candidate's bit string, so going from one candidate
+  // to the next flips only a run of its last steps. The position and gold
+  // after every step of the current candidate are cached, so each candidate
+  // costs amortized O(1) steps instead of O(len). Since candidates are not
+  // visited in increasing bit-string order, ties are broken by comparing bit
+  // strings explicitly.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_exhaustive_incremental(const grid& setting) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    const size_t max_steps = setting.rows() + setting.columns() - 2;
+    assert(max_steps < 64);
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+    const cell_kind* cells = setting.row_begin(0);
+
+    // After k valid steps the current candidate is at (row[k], column[k])
+    // with gold[k] gold; valid is the number of its steps that are valid.
+    std::vector<coordinate> row(max_steps + 1, 0), column(max_steps + 1, 0);
+    std::vector<unsigned> gold(max_steps + 1, 0);
+
+    unsigned best_gold = 0;
+    size_t best_len = 0;
+    uint64_t best_bits = 0;
+
+    for (size_t len = 1; len <= max_steps; len++) {
+      uint64_t bits = 0;
+      size_t valid = 0, changed = 0;
+
+      for (uint64_t counter = 0; ; ) {
+
+        // Re-walk steps from the first changed one, unless the candidate
+        // already stopped before it.
+        if (valid >= changed) {
+          valid = changed;
+          while (valid < len) {
+            coordinate r = row[valid], c = column[valid];
+            if ((bits >> valid) & 1) {
+              if ((c + 1 == columns) || (cells[(r * columns) + c + 1] == CELL_ROCK)) {
+                break;
+              }
+              ++c;
+            } else {
+              if ((r + 1 == rows) || (cells[((r + 1) * columns) + c] == CELL_ROCK)) {
+                break;
+              }
+              ++r;
             }
+            ++valid;
+            row[valid] = r;
+            column[valid] = c;
+            gold[valid] = gold[valid - 1] + (cells[(r * columns) + c] == CELL_GOLD);
           }
-          else {
-            // Checks if step downward is valid
-            if (candidate.is_step_valid(STEP_DIRECTION_DOWN)) {
-              // Moves down
-              candidate.add_step(STEP_DIRECTION_DOWN);
-            }
-            else {
-              // Invalid move, invalid path
-              break;
+        }
+
+        if ((gold[valid] > best_gold) ||
+            ((gold[valid] == best_gold) && (len == best_len) && (bits < best_bits))) {
+          best_gold = gold[valid];
+          best_len = len;
+          best_bits = bits;
+        }
+
+        if (++counter == (uint64_t(1) << len)) {
+          break;
+        }
+
+        // The counter's trailing zeros (its previous trailing ones) and the
+        // bit above them flipped; reversed, they are the last steps.
+        size_t flipped = __builtin_ctzll(counter) + 1;
+        changed = len - flipped;
+        bits ^= ((uint64_t(1) << flipped) - 1) << changed;
+      }
+    }
+
+    return exhaustive_candidate(setting, best_len, best_bits);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with the exhaustive
+  // search algorithm, spread over the given thread pool. Each length's
+  // candidates are split into 2^prefix_bits parts by their top prefix_bits
+  // bits (their last steps), and each part keeps its own best candidate.
+  // Merging the parts by most gold, then shortest length, then smallest bit
+  // string returns exactly the path that greedy_gnomes_exhaustive returns.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_exhaustive_parallel(const grid& setting,
+                                         ThreadPool& pool,
+                                         unsigned prefix_bits = 8) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    const size_t max_steps = setting.rows() + setting.columns() - 2;
+    assert(max_steps < 64);
+
+    const size_t k = std::min<size_t>(prefix_bits, max_steps);
+
+    // The best candidate of one part, identified by its length and bits; the
+    // empty path (0, 0) also stands in for "none".
+    struct part_best {
+      unsigned gold;
+      size_t len;
+      uint64_t bits;
+    };
+    std::vector<part_best> bests(size_t(1) << k, part_best{0, 0, 0});
+
+    pool.parallel_for(bests.size(), [&](size_t part) {
+      part_best best{0, 0, 0};
+
+      // Part 0 also takes every length too short to have k prefix bits.
+      if (part == 0) {
+        for (size_t len = 0; len < k; len++) {
+          for (uint64_t bits = 0; bits < (uint64_t(1) << len); bits++) {
+            unsigned gold = exhaustive_candidate_gold(setting, len, bits);
+            if (gold > best.gold) {
+              best = part_best{gold, len, bits};
             }
           }
-        } // End of innermost for-loop
+        }
+      }
+
+      for (size_t len = k; len <= max_steps; len++) {
+        const size_t low_bits = len - k;
+        const uint64_t high = uint64_t(part) << low_bits;
+        for (uint64_t low = 0; low < (uint64_t(1) << low_bits); low++) {
+          unsigned gold = exhaustive_candidate_gold(setting, len, high | low);
+          if (gold > best.gold) {
+            best = part_best{gold, len, high | low};
+          }
+        }
+      }
 
+      bests[part] = best;
+    });
 
-        // if candidate stays inside the grid and never crosses a CELL_ROCK (X)
-        // (NOTE: this already got taken cared of by the is_step_valid(STEP_DIRECTION__)
-        // after the bitwise operation)
-          // if best = None or if candidate harvests more gold than best
-          if (best.steps().size() == 1 || 
-              candidate.total_gold() > best.total_gold())  {
-                best = candidate;
-              } 
-        
-      } // End of 2nd for-loop
+    part_best best{0, 0, 0};
+    for (auto& candidate : bests) {
+      if ((candidate.gold > best.gold) ||
+          ((candidate.gold == best.gold) &&
+           ((candidate.len < best.len) ||
+            ((candidate.len == best.len) && (candidate.bits < best.bits))))) {
+        best = candidate;
+      }
     }
 
-    return best;
+    return exhaustive_candidate(setting, best.len, best.bits);
   }
 
+  // State of the depth-first search in greedy_gnomes_exhaustive_pruned.
+  struct exhaustive_search_state {
+    const grid& setting;
+    // remaining[(r * (columns + 1)) + c] is the number of gold cells in rows
+    // r and below and columns c and after.
+    std::vector<unsigned> remaining;
+    std::vector<step_direction> steps, best_steps;
+    unsigned best_gold;
+
+    exhaustive_search_state(const grid& s)
+    : setting(s),
+      remaining((s.rows() + 1) * (s.columns() + 1), 0),
+      best_gold(0) {
+
+      const coordinate width = s.columns() + 1;
+      for (coordinate r = s.rows(); r > 0; --r) {
+        for (coordinate c = s.columns(); c > 0; --c) {
+          remaining[((r - 1) * width) + (c - 1)] =
+            (s.get(r - 1, c - 1) == CELL_GOLD) +
+            remaining[(r * width) + (c - 1)] +
+            remaining[((r - 1) * width) + c] -
+            remaining[(r * width) + c];
+        }
+      }
+    }
+
+    // Return an upper bound on the gold that can still be added by a path
+    // that has reached (row, column).
+    unsigned bound(coordinate row, coordinate column) const {
+      return remaining[(row * (setting.columns() + 1)) + column] -
+             (setting.get(row, column) == CELL_GOLD);
+    }
+
+    // Visit the path in steps, which ends at (row, column) with the given
+    // gold, and then every valid extension of it that could beat the best
+    // path found so far.
+    void visit(coordinate row, coordinate column, unsigned gold) {
+
+      if (gold > best_gold) {
+        best_gold = gold;
+        best_steps = steps;
+      }
+
+      if ((gold + bound(row, column)) <= best_gold) {
+        return;
+      }
+
+      if (setting.may_step(row + 1, column)) {
+        steps.push_back(STEP_DIRECTION_DOWN);
+        visit(row + 1, column, gold + (setting.get(row + 1, column) == CELL_GOLD));
+        steps.pop_back();
+      }
+      if (setting.may_step(row, column + 1)) {
+        steps.push_back(STEP_DIRECTION_RIGHT);
+        visit(row, column + 1, gold + (setting.get(row, column + 1) == CELL_GOLD));
+        steps.pop_back();
+      }
+    }
+  };
+
+  // Solve the greedy gnomes problem for the given grid with a depth-first
+  // branch-and-bound search. Like greedy_gnomes_exhaustive this examines
+  // candidate paths, but it extends and retracts one step at a time, never
+  // extends a path into a rock or off the grid, and abandons a path once the
+  // gold left in the rectangle below and to the right of its end could not
+  // beat the best path found so far.
+  //
+  // The result has the most gold possible; it is the first such path in
+  // depth-first order, trying down before right.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_exhaustive_pruned(const grid& setting) {
 
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    exhaustive_search_state state(setting);
+    state.steps.reserve(setting.rows() + setting.columns() - 2);
+    state.visit(0, 0, 0);
+
+    return path(setting, state.best_steps);
+  }
+
+  // Rebuild the path that ends at (end_row, end_column) from a table holding,
+  // for every reachable cell, the step_direction used to enter that cell.
+  // The table is row-major with setting.columns() entries per row. The path
+  // is written into result, using steps as scratch space for
+  // end_row+end_column directions.
+  void dyn_prog_reconstruct(const grid& setting,
+                            const uint8_t* came_by,
+                            coordinate end_row,
+                            coordinate end_column,
+                            step_direction* steps,
+                            path& result) {
+
+    const size_t count = end_row + end_column;
+    coordinate row = end_row, column = end_column;
+    for (size_t k = count; k > 0; --k) {
+      auto dir = step_direction(came_by[(row * setting.columns()) + column]);
+      assert(dir != STEP_DIRECTION_START);
+      steps[k - 1] = dir;
+      if (dir == STEP_DIRECTION_DOWN) {
+        --row;
+      } else {
+        --column;
+      }
+    }
+    assert((row == 0) && (column == 0));
+
+    result.reset(setting);
+    for (size_t k = 0; k < count; ++k) {
+      result.add_step(steps[k]);
+    }
+  }
+
+  // Tie-break policies for dyn_prog_solve. prefer_left says whether a cell
+  // whose two neighbors tie is entered from the left (moving right) rather
+  // than from above (moving down). better_end says whether a cell with the
+  // given score should replace the best end cell so far; cells are offered
+  // in row-major order.
+
+  // Enter from above on ties; end at the first best cell in row-major order.
+  // This is the policy of greedy_gnomes_dyn_prog.
+  struct tie_prefer_down {
+    static const bool prefer_left = false;
+
+    template <typename Score>
+    static bool better_end(Score score, coordinate, coordinate,
+                           Score best_score, coordinate, coordinate) {
+      return score > best_score;
+    }
+  };
+
+  // Enter from the left on ties; end at the first best cell in row-major
+  // order.
+  struct tie_prefer_right {
+    static const bool prefer_left = true;
+
+    template <typename Score>
+    static bool better_end(Score score, coordinate, coordinate,
+                           Score best_score, coordinate, coordinate) {
+      return score > best_score;
+    }
+  };
+
+  // End at the best cell with the fewest steps, then the first in row-major
+  // order; enter from above on ties.
+  struct tie_shortest {
+    static const bool prefer_left = false;
+
+    template <typename Score>
+    static bool better_end(Score score, coordinate row, coordinate column,
+                           Score best_score, coordinate best_row, coordinate best_column) {
+      return (score > best_score) ||
+             ((score == best_score) && ((row + column) < (best_row + best_column)));
+    }
+  };
+
+  // Score type used when summing values of the given type along a path: 32
+  // bits for 8-bit values and 64 bits otherwise, always signed so that
+  // unreachable cells can be negative. 32 bits only hold the sum of about
+  // 8M 8-bit values, so greedy_gnomes_dyn_prog_weighted falls back to 64
+  // bits on grids with longer paths.
+  template <typename Value>
+  struct dyn_prog_score_for {
+    using type = int64_t;
+  };
+  template <>
+  struct dyn_prog_score_for<uint8_t> {
+    using type = int32_t;
+  };
+
+  // The dynamic programming algorithm, parameterized on the score type, the
+  // tie-break policy, and a function add_value(score, row, column, cells)
+  // returning score plus the value of column column in row row, whose cells
+  // are cells, where score is the best of the cell's neighbors and may be
+  // negative. Every choice is made at compile time, so for the unweighted
+  // grid this is the same loop as a hand-written solver.
+  //
+  // The best path is written into the context's result, and its total value
+  // into total.
+  //
+  // When live is given, only the cells in its envelopes are scored, and the
+  // rows after them are not visited at all. Every neighbor of a live cell
+  // that can be reached is live too, so live cells get their usual scores,
+  // and the best end cell, which is gold or (0, 0), is live.
+  template <typename Score, typename TieBreak, typename AddValue>
+  const path& dyn_prog_solve(const grid& setting,
+                             AddValue add_value,
+                             solver_context& context,
+                             Score& total,
+                             const live_region* live = nullptr) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+    const Score none = std::numeric_limits<Score>::min() / 2;
+
+    // score[j] holds the score of column j in the previous row until the
+    // current row overwrites it. Seeding score[0] with 0 acts as a virtual
+    // start cell above (0, 0), so (0, 0) needs no special case either.
+    Arena& memory = context.fresh_memory();
+    Score* score = memory.allocate<Score>(columns);
+    std::fill(score, score + columns, none);
+    score[0] = 0;
+
+    // Only cells that can be reached are written, and only those are read.
+    uint8_t* came_by = memory.allocate<uint8_t>(rows * columns);
+
+    Score best_score = 0;
+    coordinate best_row = 0, best_column = 0;
+
+    const coordinate solved_rows = live ? live->live_rows : rows;
+    coordinate above_first = 0, above_last = 1;
+
+    for (coordinate i = 0; i < solved_rows; ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      uint8_t* from = came_by + (i * columns);
+      Score left = none;
+
+      coordinate first = 0, last = columns;
+      if (live) {
+        // Columns outside the row above's envelope still hold older scores.
+        first = live->first[i];
+        last = live->last[i];
+        for (coordinate j = first; j < std::min(last, above_first); ++j) {
+          score[j] = none;
+        }
+        for (coordinate j = std::max(first, above_last); j < last; ++j) {
+          score[j] = none;
+        }
+        above_first = first;
+        above_last = last;
+      }
+
+      GNOMES_STAT(cells_visited, last - first);
+      GNOMES_STAT(cells_skipped, columns - (last - first));
+
+      for (coordinate j = first; j < last; ++j) {
+        Score above = score[j], here;
+
+        if (cells[j] == CELL_ROCK) {
+          here = none;
+        } else {
+          if (TieBreak::prefer_left ? (left >= above) : (left > above)) {
+            here = left;
+            from[j] = STEP_DIRECTION_RIGHT;
+          } else {
+            here = above;
+            from[j] = STEP_DIRECTION_DOWN;
+          }
+          here = add_value(here, i, j, cells);
+        }
+
+        score[j] = left = here;
+        GNOMES_STAT(cells_unreachable, here < 0);
+
+        if (TieBreak::better_end(here, i, j, best_score, best_row, best_column)) {
+          best_score = here;
+          best_row = i;
+          best_column = j;
+        }
+      }
+    }
+
+    path& best = context.fresh_result(setting);
+    dyn_prog_reconstruct(setting, came_by, best_row, best_column,
+                         memory.allocate<step_direction>(best_row + best_column),
+                         best);
+    GNOMES_STAT(cells_skipped, (rows - solved_rows) * columns);
+    GNOMES_STAT(paths_copied, 1);
+    GNOMES_STAT(bytes_allocated, memory.used());
+    total = best_score;
+    return best;
+  }
+
+  // Value function for an ordinary grid: gold cells are worth one.
+  // DP_SCORE_NONE leaves room for every path's gold, so unreachable cells
+  // stay negative without a check.
+  struct unweighted_value {
+    dp_score operator()(dp_score score, coordinate, coordinate column,
+                        const cell_kind* cells) const {
+      return score + (cells[column] == CELL_GOLD);
+    }
+  };
 
   // Solve the greedy gnomes problem for the given grid, using a dynamic
   // programming algorithm.
   //
+  // Rather than storing a whole path in every cell, this keeps one row of
+  // scores and a table of one-byte back-pointers, then reconstructs the single
+  // best path at the end. That takes O(rows*columns) time, and
+  // O(rows*columns) bytes plus O(columns) scores of memory.
+  //
+  // When two neighbors tie, the cell is entered from above. The best path ends
+  // at the first cell, in row-major order, with the most gold.
+  //
+  // The tables come from, and the result is held by, the given context.
+  //
+  // The grid must be non-empty.
+  const path& greedy_gnomes_dyn_prog(const grid& setting, solver_context& context) {
+    dp_score total;
+    return dyn_prog_solve<dp_score, tie_prefer_down>(setting, unweighted_value(),
+                                                     context, total);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with the dynamic
+  // programming algorithm above, after a find_live_region pre-pass, scoring
+  // only the cells in the live envelopes. On grids where rocks wall off most
+  // of the cells, or where the gold is near (0, 0), this skips most of the
+  // table. Returns the same path as greedy_gnomes_dyn_prog.
+  //
+  // The tables come from, and the result is held by, the given context.
+  //
+  // The grid must be non-empty.
+  const path& greedy_gnomes_dyn_prog_live(const grid& setting, solver_context& context) {
+    const live_region live = find_live_region(setting);
+    dp_score total;
+    return dyn_prog_solve<dp_score, tie_prefer_down>(setting, unweighted_value(),
+                                                     context, total, &live);
+  }
+
+  // The result of the weighted dynamic programming algorithm: the best path,
+  // on the weighted grid's terrain, and the total value it collects.
+  template <typename Value>
+  struct weighted_path {
+    path best;
+    int64_t total_value;
+  };
+
+  // The weighted dynamic programming algorithm with the given score type.
+  template <typename Score, typename TieBreak, typename Value>
+  weighted_path<Value> dyn_prog_solve_weighted(const weighted_grid<Value>& setting,
+                                               solver_context& context) {
+    const coordinate columns = setting.columns();
+    const Value* values = setting.row_values(0);
+    Score total;
+    // Values can be large enough for a long run of gold to lift an
+    // unreachable cell's score out of the negative range, so unreachable
+    // cells are kept at none.
+    const path& best = dyn_prog_solve<Score, TieBreak>(
+      setting.terrain(),
+      [values, columns](Score score, coordinate row, coordinate column, const cell_kind*) {
+        return (score < 0) ? Score(std::numeric_limits<Score>::min() / 2)
+                           : Score(score + values[(row * columns) + column]);
+      },
+      context, total);
+
+    return weighted_path<Value>{best, total};
+  }
+
+  // Solve the greedy gnomes problem for a weighted grid, maximizing the total
+  // value of the gold cells visited, with ties broken by TieBreak
+  // (tie_prefer_down, tie_prefer_right, or tie_shortest).
+  //
+  // The grid must be non-empty.
+  template <typename TieBreak = tie_prefer_down, typename Value>
+  weighted_path<Value> greedy_gnomes_dyn_prog_weighted(const weighted_grid<Value>& setting,
+                                                       solver_context& context) {
+
+    using score_type = typename dyn_prog_score_for<Value>::type;
+
+    // Every path visits rows + columns - 1 cells, so this bounds every score.
+    const double most = double(setting.rows() + setting.columns() - 1) *
+                        double(std::numeric_limits<Value>::max());
+    if (most > double(std::numeric_limits<score_type>::max())) {
+      return dyn_prog_solve_weighted<int64_t, TieBreak>(setting, context);
+    }
+    return dyn_prog_solve_weighted<score_type, TieBreak>(setting, context);
+  }
+
+  // As above, with a context of its own.
+  template <typename TieBreak = tie_prefer_down, typename Value>
+  weighted_path<Value> greedy_gnomes_dyn_prog_weighted(const weighted_grid<Value>& setting) {
+    solver_context context;
+    return greedy_gnomes_dyn_prog_weighted<TieBreak>(setting, context);
+  }
+
+  // Solve the greedy gnomes problem for the given grid, using the dynamic
+  // programming algorithm above with a context of its own.
+  //
   // The grid must be non-empty.
   path greedy_gnomes_dyn_prog(const grid& setting) {
+    solver_context context;
+    GNOMES_STAT(paths_copied, 1);
+    return greedy_gnomes_dyn_prog(setting, context);
+  }
+
+  // As greedy_gnomes_dyn_prog_live above, with a context of its own.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_dyn_prog_live(const grid& setting) {
+    solver_context context;
+    GNOMES_STAT(paths_copied, 1);
+    return greedy_gnomes_dyn_prog_live(setting, context);
+  }
+
+  // The dynamic programming algorithm for a grid of exactly Rows x Columns
+  // cells, known at compile time. The tables are std::arrays on the stack, so
+  // nothing is allocated except the returned path, and the loops have
+  // constant bounds so the compiler can unroll them. Returns the same path as
+  // greedy_gnomes_dyn_prog.
+  template <coordinate Rows, coordinate Columns>
+  path greedy_gnomes_dyn_prog_fixed(const grid& setting) {
+
+    static_assert((Rows > 0) && (Columns > 0), "grid must be non-empty");
+    static_assert((Rows * Columns) <= 4096, "use greedy_gnomes_dyn_prog for large grids");
+    assert(setting.rows() == Rows);
+    assert(setting.columns() == Columns);
+
+    std::array<dp_score, Columns> score;
+    score.fill(DP_SCORE_NONE);
+    score[0] = 0;
+    std::array<uint8_t, Rows * Columns> came_by;
+
+    dp_score best_score = 0;
+    coordinate best_row = 0, best_column = 0;
+
+    for (coordinate i = 0; i < Rows; ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      uint8_t* from = came_by.data() + (i * Columns);
+      dp_score left = DP_SCORE_NONE;
+
+#pragma GCC unroll 32
+      for (coordinate j = 0; j < Columns; ++j) {
+        const dp_score above = score[j];
+        const bool from_left = left > above;
+        dp_score here = (from_left ? left : above) + (cells[j] == CELL_GOLD);
+        from[j] = from_left ? STEP_DIRECTION_RIGHT : STEP_DIRECTION_DOWN;
+        if (cells[j] == CELL_ROCK) {
+          here = DP_SCORE_NONE;
+        }
+        score[j] = left = here;
+
+        if (here > best_score) {
+          best_score = here;
+          best_row = i;
+          best_column = j;
+        }
+      }
+    }
+
+    std::array<step_direction, Rows + Columns> steps;
+    path result(setting);
+    dyn_prog_reconstruct(setting, came_by.data(), best_row, best_column,
+                         steps.data(), result);
+    return result;
+  }
+
+  // Solve the greedy gnomes problem for the given grid, using a compile-time
+  // specialization of the dynamic programming algorithm when the grid has one
+  // of the common small sizes, and greedy_gnomes_dyn_prog otherwise.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_dyn_prog_small(const grid& setting) {
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+
+    if ((rows == 4) && (columns == 4)) {
+      return greedy_gnomes_dyn_prog_fixed<4, 4>(setting);
+    }
+    if ((rows == 4) && (columns == 5)) {
+      return greedy_gnomes_dyn_prog_fixed<4, 5>(setting);
+    }
+    if ((rows == 8) && (columns == 8)) {
+      return greedy_gnomes_dyn_prog_fixed<8, 8>(setting);
+    }
+    if ((rows == 12) && (columns == 24)) {
+      return greedy_gnomes_dyn_prog_fixed<12, 24>(setting);
+    }
+    if ((rows == 16) && (columns == 16)) {
+      return greedy_gnomes_dyn_prog_fixed<16, 16>(setting);
+    }
+    return greedy_gnomes_dyn_prog(setting);
+  }
+
+  // Solve the greedy gnomes problem for every grid in [first, last), spread
+  // over the given thread pool, and return the paths in the same order. Each
+  // thread claims grids one at a time and reuses one solver_context for all
+  // of them, so the tables are allocated about once per thread rather than
+  // once per grid.
+  //
+  // Every grid must be non-empty, and must outlive the returned paths.
+  std::vector<path> greedy_gnomes_dyn_prog_batch(const grid* first,
+                                                 const grid* last,
+                                                 ThreadPool& pool) {
+
+    assert(first <= last);
+    const size_t count = last - first;
+
+    std::vector<path> results;
+    results.reserve(count);
+    for (const grid* setting = first; setting != last; ++setting) {
+      results.emplace_back(*setting);
+    }
+
+    std::atomic<size_t> next(0);
+    pool.parallel_for(pool.size(), [&](size_t) {
+      solver_context context;
+      for (size_t i = next++; i < count; i = next++) {
+        results[i] = greedy_gnomes_dyn_prog(first[i], context);
+      }
+    });
+
+    return results;
+  }
+
+  // The total gold of a best path and the cell where it ends, for callers
+  // that do not need the steps themselves.
+  struct path_summary {
+    unsigned total_gold;
+    coordinate final_row, final_column;
+  };
+
+  // Value-only dynamic programming that receives the grid one row at a time,
+  // so the grid never needs to be held in memory at once. Only one row of
+  // scores is kept, so memory use is O(columns).
+  //
+  // The summary matches the gold and ending cell of greedy_gnomes_dyn_prog.
+  class dyn_prog_row_solver {
+  private:
+    std::vector<dp_score> score_;
+    coordinate rows_;
+    path_summary best_;
+
+  public:
+
+    // Create a solver for a grid with the given number of columns.
+    dyn_prog_row_solver(coordinate columns)
+    : score_(columns, DP_SCORE_NONE), rows_(0), best_{0, 0, 0} {
+
+      assert(columns > 0);
+      score_[0] = 0;
+    }
+
+    // Accessors.
+    coordinate columns() const { return score_.size(); }
+    coordinate rows() const { return rows_; }
+
+    // Return the best path among the rows added so far.
+    const path_summary& summary() const { return best_; }
+
+    // Consume the next row, which must hold columns() cells. The first row's
+    // first cell must be CELL_EARTH.
+    void add_row(const cell_kind* cells) {
+      assert((rows_ > 0) || (cells[0] == CELL_EARTH));
+
+      dyn_prog_score_row(cells, score_.data(), columns());
+
+      for (coordinate j = 0; j < columns(); ++j) {
+        if (score_[j] > dp_score(best_.total_gold)) {
+          best_ = path_summary{unsigned(score_[j]), rows_, j};
+        }
+      }
+      ++rows_;
+    }
+  };
+
+  // Solve the greedy gnomes problem for the given grid, returning only the
+  // total gold and final cell of the best path, in O(columns) memory.
+  //
+  // The grid must be non-empty.
+  path_summary greedy_gnomes_dyn_prog_gold(const grid& setting) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    dyn_prog_row_solver solver(setting.columns());
+    for (coordinate i = 0; i < setting.rows(); ++i) {
+      solver.add_row(setting.row_begin(i));
+    }
+    return solver.summary();
+  }
+
+  // As above, for a packed grid, such as one mapped from a grid file. Rows
+  // are unpacked one at a time, so memory use stays O(columns).
+  path_summary greedy_gnomes_dyn_prog_gold(const packed_grid_view& setting) {
+
+    dyn_prog_row_solver solver(setting.columns());
+    std::vector<cell_kind> cells(setting.columns());
+    for (coordinate i = 0; i < setting.rows(); ++i) {
+      setting.unpack_row(i, cells.data());
+      solver.add_row(cells.data());
+    }
+    return solver.summary();
+  }
+
+  // Recursive helper for greedy_gnomes_dyn_prog_linear_space. Appends to
+  // steps the best path from (top, left) to (bottom, right), both of which
+  // must be reachable cells with the latter reachable from the former, using
+  // forward and backward as scratch rows of at least setting.columns()
+  // scores.
+  //
+  // Of all best paths, this picks the one that crosses each row boundary as
+  // far right as possible, which is the path greedy_gnomes_dyn_prog finds
+  // when it prefers entering a cell from above on ties.
+  void dyn_prog_linear_space_helper(const grid& setting,
+                                    coordinate top, coordinate left,
+                                    coordinate bottom, coordinate right,
+                                    std::vector<dp_score>& forward,
+                                    std::vector<dp_score>& backward,
+                                    std::vector<step_direction>& steps) {
+
+    if (top == bottom) {
+      steps.insert(steps.end(), right - left, STEP_DIRECTION_RIGHT);
+      return;
+    }
+
+    const coordinate middle = (top + bottom) / 2,
+                     width = right - left + 1;
+
+    // Forward scores from (top, left) down to the middle row.
+    dp_score* fwd = forward.data() + left;
+    std::fill(fwd, fwd + width, DP_SCORE_NONE);
+    fwd[0] = 0;
+    for (coordinate i = top; i <= middle; ++i) {
+      dyn_prog_score_row(setting.row_begin(i) + left, fwd, width);
+    }
+
+    // Backward scores from (bottom, right) up to the row after the middle;
+    // backward[j] is the most gold on a path from that cell to the end,
+    // counting the cell itself.
+    dp_score* bwd = backward.data() + left;
+    std::fill(bwd, bwd + width, DP_SCORE_NONE);
+    bwd[width - 1] = 0;
+    for (coordinate i = bottom; i > middle; --i) {
+      const cell_kind* cells = setting.row_begin(i) + left;
+      dp_score after = DP_SCORE_NONE;
+      for (coordinate j = width; j > 0; --j) {
+        dp_score here = std::max(after, bwd[j - 1]) + (cells[j - 1] == CELL_GOLD);
+        if (cells[j - 1] == CELL_ROCK) {
+          here = DP_SCORE_NONE;
+        }
+        bwd[j - 1] = after = here;
+      }
+    }
+
+    // Step down from the middle row in the rightmost column that lies on a
+    // best path.
+    coordinate crossing = width;
+    dp_score best = DP_SCORE_NONE;
+    for (coordinate j = 0; j < width; ++j) {
+      if ((fwd[j] >= 0) && (bwd[j] >= 0) && (fwd[j] + bwd[j] >= best)) {
+        best = fwd[j] + bwd[j];
+        crossing = j;
+      }
+    }
+    assert(crossing < width);
+    crossing += left;
+
+    dyn_prog_linear_space_helper(setting, top, left, middle, crossing,
+                                 forward, backward, steps);
+    steps.push_back(STEP_DIRECTION_DOWN);
+    dyn_prog_linear_space_helper(setting, middle + 1, crossing, bottom, right,
+                                 forward, backward, steps);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with a Hirschberg-style
+  // divide and conquer algorithm. The result is the same path that
+  // greedy_gnomes_dyn_prog returns, but no rows*columns table is needed:
+  // memory use is O(rows+columns), and the running time is O(rows*columns),
+  // about twice the arithmetic of the table-based algorithm.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_dyn_prog_linear_space(const grid& setting) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+
+    auto end = greedy_gnomes_dyn_prog_gold(setting);
+
+    std::vector<dp_score> forward(setting.columns()),
+                          backward(setting.columns());
+    std::vector<step_direction> steps;
+    steps.reserve(end.final_row + end.final_column);
+    dyn_prog_linear_space_helper(setting, 0, 0, end.final_row, end.final_column,
+                                 forward, backward, steps);
+
+    return path(setting, steps);
+  }
+
+  // Solve the greedy gnomes problem for the given grid with a parallel
+  // dynamic programming algorithm, returning the same path as
+  // greedy_gnomes_dyn_prog.
+  //
+  // A cell depends only on its neighbors above and to the left, so the grid
+  // is cut into tile_size x tile_size tiles and each anti-diagonal of tiles is
+  // computed concurrently on the given thread pool. Tiles pass scores to each
+  // other through one row of bottom edges and one column of right edges, so
+  // besides the back-pointer table memory use is O(rows+columns).
+  //
+  // The grid must be non-empty, and tile_size must be positive.
+  path greedy_gnomes_dyn_prog_wavefront(const grid& setting,
+                                        ThreadPool& pool,
+                                        coordinate tile_size = 256) {
 
     // grid must be non-empty.
     assert(setting.rows() > 0);
     assert(setting.columns() > 0);
+    assert(tile_size > 0);
+
+    const coordinate rows = setting.rows(), columns = setting.columns(),
+                     tile_rows = (rows + tile_size - 1) / tile_size,
+                     tile_columns = (columns + tile_size - 1) / tile_size;
+
+    // bottom_edge[j] holds the score of column j in the last row computed so
+    // far in that column; right_edge[i] likewise for row i. Seeding
+    // bottom_edge[0] with 0 acts as a virtual start cell above (0, 0).
+    std::vector<dp_score> bottom_edge(columns, DP_SCORE_NONE),
+                          right_edge(rows, DP_SCORE_NONE);
+    bottom_edge[0] = 0;
+
+    std::vector<uint8_t> came_by(rows * columns, STEP_DIRECTION_START);
+
+    // The best cell found in each tile, the first in row-major order on ties.
+    struct tile_best {
+      dp_score score;
+      coordinate row, column;
+    };
+    std::vector<tile_best> bests(tile_rows * tile_columns, tile_best{0, 0, 0});
+
+    for (coordinate diagonal = 0; diagonal < tile_rows + tile_columns - 1; ++diagonal) {
+
+      // Tiles (ti, tj) with ti + tj == diagonal.
+      coordinate first_ti = (diagonal < tile_columns) ? 0 : (diagonal - tile_columns + 1),
+                 last_ti = std::min(diagonal, tile_rows - 1);
 
-    // TODO: implement the dynamic programming algorithm, then delete this
-    // comment.
-    path best(setting);
+      pool.parallel_for(last_ti - first_ti + 1, [&](size_t index) {
+        const coordinate ti = first_ti + index, tj = diagonal - ti,
+                         row_begin = ti * tile_size,
+                         row_end = std::min(rows, row_begin + tile_size),
+                         column_begin = tj * tile_size,
+                         column_end = std::min(columns, column_begin + tile_size);
 
-    // row x column matrix for storing paths
-    // Path_Status arr[setting.rows()][setting.columns()];
+        tile_best best{(ti == 0 && tj == 0) ? 0 : DP_SCORE_NONE, 0, 0};
 
+        for (coordinate i = row_begin; i < row_end; ++i) {
+          const cell_kind* cells = setting.row_begin(i);
+          uint8_t* from = came_by.data() + (i * columns);
+          dp_score left = right_edge[i];
 
-    // FOR 2D ARRAY
-    /*
-    for (size_t row = 0; row < setting.rows(); ++row) {
-      for (size_t col = 0; col < setting.columns(); ++col) {
-        arr[row][col].candidate
+          for (coordinate j = column_begin; j < column_end; ++j) {
+            dp_score above = bottom_edge[j], here;
+
+            if (cells[j] == CELL_ROCK) {
+              here = DP_SCORE_NONE;
+            } else {
+              if (left > above) {
+                here = left;
+                from[j] = STEP_DIRECTION_RIGHT;
+              } else {
+                here = above;
+                from[j] = STEP_DIRECTION_DOWN;
+              }
+              here += (cells[j] == CELL_GOLD);
+            }
+
+            bottom_edge[j] = left = here;
+
+            if (here > best.score) {
+              best = tile_best{here, i, j};
+            }
+          }
+
+          right_edge[i] = left;
+        }
+
+        bests[(ti * tile_columns) + tj] = best;
+      });
+    }
+
+    // Reduce the tile results; comparing tiles in row-major order is not the
+    // same as comparing cells in row-major order, so break ties explicitly.
+    tile_best best{0, 0, 0};
+    for (auto& candidate : bests) {
+      if ((candidate.score > best.score) ||
+          ((candidate.score == best.score) &&
+           ((candidate.row < best.row) ||
+            ((candidate.row == best.row) && (candidate.column < best.column))))) {
+        best = candidate;
       }
     }
-    */
 
-    // 2D vector of data type Path_Status 
-     std::vector<std::vector<Path_Status>> vec(setting.rows(), 
-        std::vector<Path_Status>(setting.columns(), Path_Status(setting)));
+    std::vector<step_direction> steps(best.row + best.column);
+    path result(setting);
+    dyn_prog_reconstruct(setting, came_by.data(), best.row, best.column,
+                         steps.data(), result);
+    return result;
+  }
+
+  // A dynamic programming solution that stays up to date as cells of its grid
+  // change. The whole score table is kept, so after set(row, column, kind)
+  // only cells below and to the right of the edit are recomputed, and the
+  // recomputation stops as soon as a row's scores come out unchanged.
+  //
+  // best_path() always equals greedy_gnomes_dyn_prog(setting()).
+  class dyn_prog_incremental {
+  private:
+    grid setting_;
+    std::vector<dp_score> score_;
+    std::vector<uint8_t> came_by_;
+    // The best score in each row and the first column holding it.
+    std::vector<dp_score> row_best_score_;
+    std::vector<coordinate> row_best_column_;
+    // Which columns changed score in the previous and current row of an
+    // update; all zero between updates.
+    std::vector<uint8_t> changed_above_, changed_here_;
+    size_t cells_recomputed_;
+
+    // Recompute the score and back-pointer of one cell, and return true if
+    // its score changed.
+    bool recompute(coordinate i, coordinate j) {
+      const coordinate columns = setting_.columns();
+      const size_t index = (i * columns) + j;
+      dp_score above = (i > 0) ? score_[index - columns] : ((j == 0) ? 0 : DP_SCORE_NONE),
+               left = (j > 0) ? score_[index - 1] : DP_SCORE_NONE,
+               here;
 
-  //  std::vector<size_t> vec_ptrs(max_steps+1, 0); // allocate space for subset and initialize values to 0
+      cell_kind cell = setting_.row_begin(i)[j];
+      if (cell == CELL_ROCK) {
+        here = DP_SCORE_NONE;
+      } else {
+        if (left > above) {
+          here = left;
+          came_by_[index] = STEP_DIRECTION_RIGHT;
+        } else {
+          here = above;
+          came_by_[index] = STEP_DIRECTION_DOWN;
+        }
+        here += (cell == CELL_GOLD);
+      }
+
+      ++cells_recomputed_;
+      // Unreachable cells count as unchanged whatever their exact negative
+      // score is, since it never affects a reachable cell.
+      bool changed = (here != score_[index]) && ((here >= 0) || (score_[index] >= 0));
+      score_[index] = here;
+      return changed;
+    }
 
-    // Base case
-    vec[0][0].candidate_path.add_step(STEP_DIRECTION_START); 
-    //arr[0][0].candidate_path.add_step(STEP_DIRECTION_START); 
+    // Recompute the best score in the given row.
+    void update_row_best(coordinate i) {
+      const dp_score* row = score_.data() + (i * setting_.columns());
+      auto best = std::max_element(row, row + setting_.columns());
+      row_best_score_[i] = *best;
+      row_best_column_[i] = best - row;
+    }
+
+  public:
 
-    // General case
-    for (size_t i = 0; i < setting.rows(); ++i) {
-      for (size_t j = 0; j < setting.columns(); ++j) {
+    // Solve the given grid, which is copied and must be non-empty.
+    dyn_prog_incremental(const grid& setting)
+    : setting_(setting),
+      score_(setting.rows() * setting.columns(), DP_SCORE_NONE),
+      came_by_(setting.rows() * setting.columns(), STEP_DIRECTION_START),
+      row_best_score_(setting.rows()),
+      row_best_column_(setting.rows()),
+      changed_above_(setting.columns(), 0),
+      changed_here_(setting.columns(), 0),
+      cells_recomputed_(0) {
 
-        // if rock (X) is not encountered
-        if (!setting.may_step(i, j)) {
-          // Continue moving
-          vec[i][j].is_None = true;
-          continue;          
+      for (coordinate i = 0; i < setting_.rows(); ++i) {
+        for (coordinate j = 0; j < setting_.columns(); ++j) {
+          recompute(i, j);
         }
-        //Path_Status from_above = Path_Status(setting);
-        //Path_Status from_left = Path_Status(setting);
-        path from_above(setting);
-        path from_left(setting);
+        update_row_best(i);
+      }
+    }
+
+    // Accessors.
+    const grid& setting() const { return setting_; }
+
+    // Return the number of cell recomputations so far, including the
+    // initial solve.
+    size_t cells_recomputed() const { return cells_recomputed_; }
+
+    // Change one cell of the grid, with the same rules as grid::set, and
+    // bring the solution up to date.
+    void set(coordinate row, coordinate column, cell_kind kind) {
+
+      if (setting_.get(row, column) == kind) {
+        return;
+      }
+      setting_.set(row, column, kind);
+
+      const coordinate rows = setting_.rows(), columns = setting_.columns();
+
+      // Columns [low, high] of the previous row hold every changed cell.
+      coordinate low = column, high = column;
+      bool first = true;
 
+      for (coordinate i = row; i < rows; ++i) {
+        coordinate new_low = columns, new_high = 0;
+        bool left_changed = false;
 
-        // When we are not on the top row, move down
-        if (i > 0 && vec[i - 1][j].is_None == false) {
-          // Move down
-          from_above = vec[i - 1][j].candidate_path.add_step(STEP_DIRECTION_DOWN);
+        for (coordinate j = low; j < columns; ++j) {
+          bool above_changed = first ? (j == column) : (changed_above_[j] != 0);
+          if (!above_changed && !left_changed) {
+            if (j >= high) {
+              break;
+            }
+            continue;
+          }
+
+          left_changed = recompute(i, j);
+          if (left_changed) {
+            changed_here_[j] = 1;
+            new_low = std::min(new_low, j);
+            new_high = j;
+          }
+        }
+
+        if (!first) {
+          std::fill(changed_above_.begin() + low, changed_above_.begin() + high + 1, 0);
         }
-        
-        // When we are not at the leftmost column, move right
-        if (j > 0 && vec[i][j - 1].is_None == false) {
-          // Move right
-          from_left = vec[i][j - 1].candidate_path.add_step(STEP_DIRECTION_RIGHT);
+        first = false;
+
+        // Even without a score change, back-pointers in this row may have
+        // changed, but the row's best cannot have.
+        if (new_low == columns) {
+          break;
         }
+        update_row_best(i);
 
+        std::swap(changed_above_, changed_here_);
+        low = new_low;
+        high = new_high;
       }
+
+      std::fill(changed_above_.begin(), changed_above_.end(), 0);
     }
 
-    // Post-processing step
+    // Return the total gold of the best path.
+    unsigned total_gold() const {
+      return unsigned(std::max(dp_score(0),
+                               *std::max_element(row_best_score_.begin(),
+                                                 row_best_score_.end())));
+    }
 
-    return best;
+    // Return the best path, which ends at the first cell, in row-major order,
+    // with the most gold.
+    path best_path() const {
+      dp_score best_score = 0;
+      coordinate best_row = 0, best_column = 0;
+      for (coordinate i = 0; i < setting_.rows(); ++i) {
+        if (row_best_score_[i] > best_score) {
+          best_score = row_best_score_[i];
+          best_row = i;
+          best_column = row_best_column_[i];
+        }
+      }
+
+      std::vector<step_direction> steps(best_row + best_column);
+      path result(setting_);
+      dyn_prog_reconstruct(setting_, came_by_.data(), best_row, best_column,
+                           steps.data(), result);
+      return result;
+    }
+  };
+
+  // Solve the greedy gnomes problem for the given grid, returning the k
+  // distinct paths with the most gold, best first. Fewer than k paths are
+  // returned when the grid has fewer valid paths.
+  //
+  // Every cell keeps a list of its k best scores in decreasing order, each
+  // with the direction it was entered from and its rank in that neighbor's
+  // list; a cell's list is the top k of its two neighbors' lists merged. Each
+  // entry stands for a different path, so the k best entries over all cells
+  // are the k best paths. Merging the lists takes O(k*rows*columns) time and
+  // memory, and picking the k best entries with a heap of size k takes
+  // O(k*log(k)*rows*columns) time at worst.
+  //
+  // Ties are broken as in greedy_gnomes_dyn_prog, so the first path is the one
+  // greedy_gnomes_dyn_prog returns; after that, ties go to the path that ends
+  // first in row-major order.
+  //
+  // The grid must be non-empty, and 0 < k < 65536.
+  std::vector<path> greedy_gnomes_dyn_prog_top_k(const grid& setting, size_t k) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+    assert(k > 0);
+    assert(k <= std::numeric_limits<uint16_t>::max());
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+
+    struct entry {
+      dp_score score;
+      uint16_t rank;   // rank in the list of the cell it was entered from
+      uint8_t came_by; // step_direction
+    };
+    std::vector<entry> lists(rows * columns * k);
+    std::vector<uint16_t> counts(rows * columns, 0);
+
+    for (coordinate i = 0; i < rows; ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      for (coordinate j = 0; j < columns; ++j) {
+        const size_t index = (i * columns) + j;
+        if (cells[j] == CELL_ROCK) {
+          continue;
+        }
+        entry* out = lists.data() + (index * k);
+        const dp_score gold = (cells[j] == CELL_GOLD);
+
+        if (index == 0) {
+          out[0] = entry{0, 0, STEP_DIRECTION_START};
+          counts[0] = 1;
+          continue;
+        }
+
+        const entry* above = (i > 0) ? (out - (columns * k)) : nullptr;
+        const entry* left = (j > 0) ? (out - k) : nullptr;
+        size_t above_count = (i > 0) ? counts[index - columns] : 0,
+               left_count = (j > 0) ? counts[index - 1] : 0,
+               a = 0, l = 0, n = 0;
+
+        while ((n < k) && ((a < above_count) || (l < left_count))) {
+          if ((l == left_count) ||
+              ((a < above_count) && (above[a].score >= left[l].score))) {
+            out[n++] = entry{above[a].score + gold, uint16_t(a), STEP_DIRECTION_DOWN};
+            ++a;
+          } else {
+            out[n++] = entry{left[l].score + gold, uint16_t(l), STEP_DIRECTION_RIGHT};
+            ++l;
+          }
+        }
+        counts[index] = n;
+      }
+    }
+
+    // Pick the k best entries over all cells, keeping them in a heap whose
+    // front is the worst. Cells are visited in row-major order and each list
+    // is sorted, so an entry that only ties the worst is never better than
+    // it, and neither is the rest of its list.
+    struct choice {
+      dp_score score;
+      size_t index;
+      uint16_t rank;
+    };
+    auto better = [](const choice& x, const choice& y) {
+      return (x.score > y.score) ||
+             ((x.score == y.score) &&
+              ((x.index < y.index) || ((x.index == y.index) && (x.rank < y.rank))));
+    };
+    std::vector<choice> chosen;
+    chosen.reserve(k);
+    for (size_t index = 0; index < counts.size(); ++index) {
+      for (uint16_t rank = 0; rank < counts[index]; ++rank) {
+        dp_score score = lists[(index * k) + rank].score;
+        if (chosen.size() == k) {
+          if (score <= chosen.front().score) {
+            break;
+          }
+          std::pop_heap(chosen.begin(), chosen.end(), better);
+          chosen.pop_back();
+        }
+        chosen.push_back(choice{score, index, rank});
+        std::push_heap(chosen.begin(), chosen.end(), better);
+      }
+    }
+    std::sort_heap(chosen.begin(), chosen.end(), better);
+
+    std::vector<path> results;
+    std::vector<step_direction> steps;
+    for (auto& c : chosen) {
+      coordinate row = c.index / columns, column = c.index % columns;
+      steps.assign(row + column, STEP_DIRECTION_START);
+      size_t index = c.index;
+      uint16_t rank = c.rank;
+      for (size_t s = steps.size(); s > 0; --s) {
+        const entry& e = lists[(index * k) + rank];
+        steps[s - 1] = step_direction(e.came_by);
+        index -= (e.came_by == STEP_DIRECTION_DOWN) ? columns : 1;
+        rank = e.rank;
+      }
+      assert(index == 0);
+      results.emplace_back(setting, steps);
+    }
+
+    return results;
+  }
+
+  // Return bit j of the result set for every column j at or after some bit
+  // of reach within the same run of set bits of open, i.e. every cell that can
+  // be reached by moving right, without crossing rock, from a cell in reach.
+  // reach must be a subset of open. Runs in log2(64) shift-and-or steps.
+  uint64_t bitboard_fill_right(uint64_t reach, uint64_t open) {
+    uint64_t through = open;
+    reach |= through & (reach << 1);
+    through &= through << 1;
+    reach |= through & (reach << 2);
+    through &= through << 2;
+    reach |= through & (reach << 4);
+    through &= through << 4;
+    reach |= through & (reach << 8);
+    through &= through << 8;
+    reach |= through & (reach << 16);
+    through &= through << 16;
+    reach |= through & (reach << 32);
+    return reach;
+  }
+
+  // Return, for a grid with at most 64 columns, one mask per row with bit j
+  // set when (row, j) can be reached from (0, 0). Rows after the first row
+  // with no reachable cell are all zero.
+  std::vector<uint64_t> bitboard_reachable(const grid& setting) {
+
+    assert(setting.columns() <= 64);
+
+    std::vector<uint64_t> reach(setting.rows(), 0);
+    uint64_t above = 1;
+    for (coordinate i = 0; (i < setting.rows()) && (above != 0); ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      uint64_t open = 0;
+      for (coordinate j = 0; j < setting.columns(); ++j) {
+        open |= uint64_t(cells[j] != CELL_ROCK) << j;
+      }
+      above = reach[i] = bitboard_fill_right(above & open, open);
+    }
+    return reach;
+  }
+
+  // Solve the greedy gnomes problem for a grid with at most 64 columns. Each
+  // row's reachable cells are first found as a bitboard with
+  // bitboard_reachable; the dynamic programming then visits only the set bits
+  // of each row, and stops at the first row with none, so walled-off and
+  // rock-heavy regions are skipped a word at a time. Returns the same path as
+  // greedy_gnomes_dyn_prog.
+  //
+  // The grid must be non-empty.
+  path greedy_gnomes_dyn_prog_bitboard(const grid& setting) {
+
+    // grid must be non-empty.
+    assert(setting.rows() > 0);
+    assert(setting.columns() > 0);
+    assert(setting.columns() <= 64);
+
+    const coordinate rows = setting.rows(), columns = setting.columns();
+    const std::vector<uint64_t> reach = bitboard_reachable(setting);
+
+    // Scores of the previous and current rows; only reachable cells are
+    // written or read.
+    std::array<dp_score, 64> above_score, score;
+    std::vector<uint8_t> came_by(rows * columns, STEP_DIRECTION_START);
+
+    dp_score best_score = 0;
+    coordinate best_row = 0, best_column = 0;
+
+    uint64_t above = 0;
+    for (coordinate i = 0; (i < rows) && (reach[i] != 0); ++i) {
+      const cell_kind* cells = setting.row_begin(i);
+      uint8_t* from = came_by.data() + (i * columns);
+
+      for (uint64_t todo = reach[i]; todo != 0; todo &= todo - 1) {
+        const coordinate j = __builtin_ctzll(todo);
+        const bool has_above = (above >> j) & 1,
+                   has_left = (j > 0) && ((reach[i] >> (j - 1)) & 1);
+        dp_score here = 0;
+
+        if (has_left && (!has_above || (score[j - 1] > above_score[j]))) {
+          here = score[j - 1];
+          from[j] = STEP_DIRECTION_RIGHT;
+        } else if (has_above) {
+          here = above_score[j];
+          from[j] = STEP_DIRECTION_DOWN;
+        }
+        here += (cells[j] == CELL_GOLD);
+        score[j] = here;
+
+        if (here > best_score) {
+          best_score = here;
+          best_row = i;
+          best_column = j;
+        }
+      }
+
+      std::swap(above_score, score);
+      above = reach[i];
+    }
+
+    std::vector<step_direction> steps(best_row + best_column);
+    path result(setting);
+    dyn_prog_reconstruct(setting, came_by.data(), best_row, best_column,
+                         steps.data(), result);
+    return result;
   }
 
-  
 }
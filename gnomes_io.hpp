@@ -0,0 +1,450 @@
+///////////////////////////////////////////////////////////////////////////////
+// gnomes_io.hpp
+//
+// Reading and writing grids in a compact binary file format, and reading
+// grids in the text format of grid::printable().
+//
+// A grid file is a 32-byte header followed by the grid's cells packed the
+// same way as packed_grid_view: two bits per cell, 32 cells per 64-bit word,
+// every row starting on a new word. The header is
+//
+//    bytes  0-7   the magic string GRID_FILE_MAGIC
+//    bytes  8-15  number of rows, as a 64-bit integer
+//    bytes 16-23  number of columns, as a 64-bit integer
+//    bytes 24-31  words per row, as a 64-bit integer
+//
+// All integers are in the byte order of the machine that wrote the file,
+// which must match the machine that reads it; files written on a different
+// byte order fail the magic check.
+//
+// Since the header is a whole number of words, a file mapped into memory
+// can be used as a packed_grid_view as-is, with no copying or decoding, and
+// opening a file of any size only costs a few system calls. Pages are read
+// from disk as the solver touches them.
+//
+// How to use:
+//
+//    gnomes::write_grid_file("map.grid", setting);
+//    gnomes::mapped_grid_file file;
+//    if (file.open("map.grid")) {
+//      auto summary = gnomes::greedy_gnomes_dyn_prog_gold(file.view());
+//    }
+//
+// The text format has one line per row, with '.' for earth, 'X' for rock,
+// and 'g' for gold. grid_text_reader parses it a row at a time from large
+// chunks of the stream, so a row-streaming solver can consume a grid that
+// never exists in memory all at once:
+//
+//    gnomes::grid_text_reader reader(std::cin);
+//    const gnomes::cell_kind* row = reader.next_row();
+//    gnomes::dyn_prog_row_solver solver(reader.columns());
+//    for (; row != nullptr; row = reader.next_row()) {
+//      solver.add_row(row);
+//    }
+//    if (reader.failed()) { std::cerr << reader.error() << std::endl; }
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "gnomes_types.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GNOMES_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gnomes {
+
+  // First eight bytes of every grid file. The trailing byte is the format
+  // version.
+  const char GRID_FILE_MAGIC[8] = {'G', 'N', 'O', 'M', 'E', 'S', 'G', 1};
+
+  // Layout of the header at the start of a grid file.
+  struct grid_file_header {
+    char magic[8];
+    uint64_t rows, columns, words_per_row;
+  };
+  static_assert(sizeof(grid_file_header) == 32, "grid file header must be four words");
+
+  // Write the given packed grid to the named file, replacing it. Returns
+  // false if the file could not be written.
+  bool write_grid_file(const std::string& filename, const packed_grid_view& setting) {
+
+    grid_file_header header;
+    std::memcpy(header.magic, GRID_FILE_MAGIC, sizeof(header.magic));
+    header.rows = setting.rows();
+    header.columns = setting.columns();
+    header.words_per_row = setting.words_per_row();
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(setting.row_words(0)),
+              setting.rows() * setting.words_per_row() * sizeof(uint64_t));
+    out.close();
+    return bool(out);
+  }
+
+  // Write the given grid to the named file, replacing it, packing one row at
+  // a time. Returns false if the file could not be written.
+  bool write_grid_file(const std::string& filename, const grid& setting) {
+
+    const coordinate columns = setting.columns();
+    const size_t words_per_row = packed_grid_view::words_per_row(columns);
+
+    grid_file_header header;
+    std::memcpy(header.magic, GRID_FILE_MAGIC, sizeof(header.magic));
+    header.rows = setting.rows();
+    header.columns = columns;
+    header.words_per_row = words_per_row;
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint64_t> words(words_per_row);
+    for (coordinate row = 0; (row < setting.rows()) && out; ++row) {
+      std::fill(words.begin(), words.end(), 0);
+      const cell_kind* cells = setting.row_begin(row);
+      for (coordinate column = 0; column < columns; ++column) {
+        words[column / packed_grid_view::CELLS_PER_WORD] |=
+          uint64_t(cells[column]) << (2 * (column % packed_grid_view::CELLS_PER_WORD));
+      }
+      out.write(reinterpret_cast<const char*>(words.data()),
+                words_per_row * sizeof(uint64_t));
+    }
+    out.close();
+    return bool(out);
+  }
+
+  // A grid file opened for reading. Where the platform supports it the file
+  // is memory-mapped read-only, so view() refers straight to the mapped
+  // pages; elsewhere the words are read into memory.
+  //
+  // The cells are not validated, so a file that was not written by
+  // write_grid_file may hold the unused two-bit value 3.
+  class mapped_grid_file {
+  private:
+    grid_file_header header_;
+    const uint64_t* words_;
+#ifdef GNOMES_MMAP
+    void* mapping_;
+    size_t mapping_size_;
+#else
+    std::vector<uint64_t> buffer_;
+#endif
+
+    // Return true if header_ describes a grid of file_size bytes.
+    bool header_valid(uint64_t file_size) const {
+      if ((std::memcmp(header_.magic, GRID_FILE_MAGIC, sizeof(header_.magic)) != 0) ||
+          (header_.rows == 0) || (header_.columns == 0) ||
+          (header_.words_per_row != packed_grid_view::words_per_row(header_.columns))) {
+        return false;
+      }
+      const uint64_t max_words = (file_size - sizeof(header_)) / sizeof(uint64_t);
+      return (header_.rows <= (max_words / header_.words_per_row)) &&
+             (file_size == (sizeof(header_) +
+                            (header_.rows * header_.words_per_row * sizeof(uint64_t))));
+    }
+
+  public:
+
+    // Create an object with no file open.
+    mapped_grid_file()
+    : words_(nullptr)
+#ifdef GNOMES_MMAP
+      , mapping_(nullptr), mapping_size_(0)
+#endif
+    { }
+
+    mapped_grid_file(const mapped_grid_file&) = delete;
+    mapped_grid_file& operator=(const mapped_grid_file&) = delete;
+
+    ~mapped_grid_file() {
+      close();
+    }
+
+    // Open the named grid file, closing any file that was open. Returns
+    // false if the file cannot be read or is not a valid grid file.
+    bool open(const std::string& filename) {
+      close();
+
+#ifdef GNOMES_MMAP
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0) {
+        return false;
+      }
+      struct stat status;
+      if ((::fstat(fd, &status) != 0) ||
+          (uint64_t(status.st_size) < sizeof(header_)) ||
+          (::pread(fd, &header_, sizeof(header_), 0) != ssize_t(sizeof(header_))) ||
+          !header_valid(status.st_size)) {
+        ::close(fd);
+        return false;
+      }
+      void* mapping = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (mapping == MAP_FAILED) {
+        return false;
+      }
+      // The solvers read rows front to back.
+      ::madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+      mapping_ = mapping;
+      mapping_size_ = status.st_size;
+      words_ = reinterpret_cast<const uint64_t*>(
+                 static_cast<const char*>(mapping) + sizeof(header_));
+#else
+      std::ifstream in(filename, std::ios::binary | std::ios::ate);
+      if (!in) {
+        return false;
+      }
+      const uint64_t file_size = in.tellg();
+      in.seekg(0);
+      if ((file_size < sizeof(header_)) ||
+          !in.read(reinterpret_cast<char*>(&header_), sizeof(header_)) ||
+          !header_valid(file_size)) {
+        return false;
+      }
+      buffer_.resize(header_.rows * header_.words_per_row);
+      if (!in.read(reinterpret_cast<char*>(buffer_.data()),
+                   buffer_.size() * sizeof(uint64_t))) {
+        buffer_.clear();
+        return false;
+      }
+      words_ = buffer_.data();
+#endif
+      return true;
+    }
+
+    // Release the open file, if any.
+    void close() {
+#ifdef GNOMES_MMAP
+      if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+      }
+#else
+      buffer_.clear();
+#endif
+      words_ = nullptr;
+    }
+
+    // Return true if a file is open.
+    bool is_open() const { return words_ != nullptr; }
+
+    // Accessors; a file must be open.
+    coordinate rows() const { assert(is_open()); return header_.rows; }
+    coordinate columns() const { assert(is_open()); return header_.columns; }
+
+    // Return a view of the grid, which remains valid until the file is
+    // closed. A file must be open.
+    packed_grid_view view() const {
+      assert(is_open());
+      return packed_grid_view(header_.rows, header_.columns, words_);
+    }
+  };
+
+  // Parses grid text from a stream one row at a time. Rows are lines of
+  // '.', 'X', and 'g'; a line may end in "\r\n", the last line need not end
+  // in a newline, and empty lines are skipped. Every row must have the same
+  // number of cells as the first.
+  //
+  // The stream is read in chunks with istream::read, and each line is
+  // located with memchr and decoded through a lookup table, so there is no
+  // per-character stream call. Only a line that spans two chunks is copied.
+  class grid_text_reader {
+  private:
+    std::istream& in_;
+    std::vector<char> buffer_;
+    const char* next_;
+    const char* end_;
+    std::string pending_;
+    std::vector<cell_kind> row_;
+    coordinate rows_, columns_;
+    size_t bytes_;
+    std::string error_;
+
+    // Bits set in a decoded character that is not a cell.
+    static const uint8_t INVALID = 0x80;
+
+    // Return the table that maps a character to its cell_kind, or INVALID.
+    static const uint8_t* decode_table() {
+      static const struct table {
+        uint8_t kinds[256];
+        table() {
+          std::fill(kinds, kinds + 256, uint8_t(INVALID));
+          kinds[uint8_t('.')] = CELL_EARTH;
+          kinds[uint8_t('X')] = CELL_ROCK;
+          kinds[uint8_t('g')] = CELL_GOLD;
+        }
+      } instance;
+      return instance.kinds;
+    }
+
+    // Read the next chunk into the buffer. Returns false at end of input.
+    bool refill() {
+      in_.read(buffer_.data(), buffer_.size());
+      const size_t count = in_.gcount();
+      bytes_ += count;
+      next_ = buffer_.data();
+      end_ = next_ + count;
+      return count > 0;
+    }
+
+    // Decode the line [first, last) into row_. Returns false, setting
+    // error_, if the line is malformed; sets skipped for an empty line.
+    bool decode(const char* first, const char* last, bool& skipped) {
+      if ((last > first) && (last[-1] == '\r')) {
+        --last;
+      }
+      const coordinate width = last - first;
+      skipped = (width == 0);
+      if (skipped) {
+        return true;
+      }
+
+      if (rows_ == 0) {
+        columns_ = width;
+        row_.resize(width);
+      } else if (width != columns_) {
+        error_ = "row " + std::to_string(rows_) + " has " + std::to_string(width) +
+                 " cells, expected " + std::to_string(columns_);
+        return false;
+      }
+
+      const uint8_t* kinds = decode_table();
+      uint8_t seen = 0;
+      for (coordinate j = 0; j < width; ++j) {
+        const uint8_t kind = kinds[uint8_t(first[j])];
+        seen |= kind;
+        row_[j] = cell_kind(kind & 3);
+      }
+      if (seen & INVALID) {
+        error_ = "row " + std::to_string(rows_) + " holds a character other than '.', 'X', or 'g'";
+        return false;
+      }
+
+      ++rows_;
+      return true;
+    }
+
+  public:
+
+    // Default chunk size.
+    static const size_t CHUNK_BYTES = 1 << 20;
+
+    // Create a reader of the given stream, which must outlive it.
+    explicit grid_text_reader(std::istream& in, size_t chunk_bytes = CHUNK_BYTES)
+    : in_(in), buffer_(chunk_bytes), next_(nullptr), end_(nullptr),
+      rows_(0), columns_(0), bytes_(0) {
+
+      assert(chunk_bytes > 0);
+    }
+
+    grid_text_reader(const grid_text_reader&) = delete;
+    grid_text_reader& operator=(const grid_text_reader&) = delete;
+
+    // Return the cells of the next row, which stay valid until the next
+    // call, or nullptr at the end of the input or on a malformed row.
+    const cell_kind* next_row() {
+      if (failed()) {
+        return nullptr;
+      }
+      for (;;) {
+        bool skipped;
+        if ((next_ == end_) && !refill()) {
+          // End of input; the pending text is a last line with no newline.
+          if (pending_.empty()) {
+            return nullptr;
+          }
+          std::string line;
+          line.swap(pending_);
+          if (!decode(line.data(), line.data() + line.size(), skipped)) {
+            return nullptr;
+          }
+          if (skipped) {
+            return nullptr;
+          }
+          return row_.data();
+        }
+
+        auto newline = static_cast<const char*>(std::memchr(next_, '\n', end_ - next_));
+        if (newline == nullptr) {
+          pending_.append(next_, end_);
+          next_ = end_;
+          continue;
+        }
+
+        bool decoded;
+        if (pending_.empty()) {
+          decoded = decode(next_, newline, skipped);
+        } else {
+          pending_.append(next_, newline);
+          decoded = decode(pending_.data(), pending_.data() + pending_.size(), skipped);
+          pending_.clear();
+        }
+        next_ = newline + 1;
+        if (!decoded) {
+          return nullptr;
+        }
+        if (!skipped) {
+          return row_.data();
+        }
+      }
+    }
+
+    // Return the number of rows returned so far, and the number of cells in
+    // each (0 before the first row).
+    coordinate rows() const { return rows_; }
+    coordinate columns() const { return columns_; }
+
+    // Return the number of bytes read from the stream so far.
+    size_t bytes_read() const { return bytes_; }
+
+    // Return true if a malformed row stopped the reader, and a description
+    // of the problem.
+    bool failed() const { return !error_.empty(); }
+    const std::string& error() const { return error_; }
+  };
+
+  // Read a whole grid in text format from the given stream into result.
+  // Returns false, leaving result alone, if the text is malformed, holds no
+  // rows, or has rock at (0, 0); error, if given, then describes why.
+  bool read_grid_text(std::istream& in, grid& result, std::string* error = nullptr) {
+
+    grid_text_reader reader(in);
+    std::vector<cell_kind> cells;
+    for (const cell_kind* row = reader.next_row(); row != nullptr; row = reader.next_row()) {
+      cells.insert(cells.end(), row, row + reader.columns());
+    }
+
+    std::string problem = reader.error();
+    if (problem.empty() && (reader.rows() == 0)) {
+      problem = "no rows";
+    } else if (problem.empty() && (cells[0] == CELL_ROCK)) {
+      problem = "rock at (0, 0)";
+    }
+    if (!problem.empty()) {
+      if (error != nullptr) {
+        *error = problem;
+      }
+      return false;
+    }
+
+    result = grid(reader.rows(), reader.columns(), std::move(cells));
+    return true;
+  }
+
+}
@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// gnomes_kernels.hpp
+//
+// Row kernels for the dynamic programming algorithms in gnomes_algs.hpp.
+//
+// A row kernel computes the scores of one grid row from the scores of the
+// row above it:
+//
+//   score[j] = rock[j] ? NONE : max(above[j], score[j-1]) + gold[j]
+//
+// The dependency on score[j-1] makes this a scan. Written as the max-plus map
+// x -> max(a[j], x + c[j]), with a[j] = above[j] + gold[j] and c[j] = gold[j]
+// (both NONE on rock), consecutive maps compose into another map of the same
+// form, so a block of lanes can be scanned in log2(lanes) shift-max-add steps.
+// The SIMD kernels do that, then carry the last lane into the next block.
+//
+// dyn_prog_score_row picks the widest kernel the CPU supports the first time
+// it is called.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "gnomes_types.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GNOMES_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace gnomes {
+
+  // Score of one cell in the dynamic programming algorithm: the most gold
+  // that can be harvested on a path from (0, 0) to that cell. A cell that no
+  // path can reach has a negative score. DP_SCORE_NONE is far enough below
+  // zero that adding the gold along any path cannot bring it back up to zero,
+  // so the recurrence needs no special case for unreachable neighbors.
+  using dp_score = int32_t;
+  const dp_score DP_SCORE_NONE = std::numeric_limits<dp_score>::min() / 2;
+
+  // Type of a row kernel. score holds the previous row's scores on entry
+  // (or DP_SCORE_NONE everywhere except a 0 above (0, 0), before the first
+  // row) and this row's scores on return. Scores of unreachable cells may
+  // differ between kernels, but are always negative.
+  using dyn_prog_row_kernel = void (*)(const cell_kind* cells,
+                                       dp_score* score,
+                                       coordinate columns);
+
+  // The plain loop, used when no SIMD kernel is available.
+  void dyn_prog_score_row_scalar(const cell_kind* cells,
+                                 dp_score* score,
+                                 coordinate columns) {
+    dp_score left = DP_SCORE_NONE;
+    for (coordinate j = 0; j < columns; ++j) {
+      dp_score here = std::max(left, score[j]) + (cells[j] == CELL_GOLD);
+      if (cells[j] == CELL_ROCK) {
+        here = DP_SCORE_NONE;
+      }
+      score[j] = left = here;
+    }
+  }
+
+#ifdef GNOMES_X86_KERNELS
+
+  // Eight lanes per step.
+  __attribute__((target("avx2")))
+  void dyn_prog_score_row_avx2(const cell_kind* cells,
+                               dp_score* score,
+                               coordinate columns) {
+
+    const __m256i none = _mm256_set1_epi32(DP_SCORE_NONE),
+                  zero = _mm256_setzero_si256(),
+                  rock_kind = _mm256_set1_epi32(CELL_ROCK),
+                  gold_kind = _mm256_set1_epi32(CELL_GOLD),
+                  one = _mm256_set1_epi32(1),
+                  shift1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6),
+                  shift2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5),
+                  shift4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3),
+                  last = _mm256_set1_epi32(7);
+
+    __m256i carry = none;
+    coordinate j = 0;
+    for (; j + 8 <= columns; j += 8) {
+      __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(cells + j));
+      __m256i kinds = _mm256_cvtepu8_epi32(bytes),
+              rock = _mm256_cmpeq_epi32(kinds, rock_kind),
+              gold = _mm256_and_si256(_mm256_cmpeq_epi32(kinds, gold_kind), one),
+              above = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(score + j));
+
+      __m256i a = _mm256_blendv_epi8(_mm256_add_epi32(above, gold), none, rock),
+              c = _mm256_blendv_epi8(gold, none, rock), shifted;
+
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(a, shift1), none, 0x01);
+      a = _mm256_max_epi32(a, _mm256_max_epi32(_mm256_add_epi32(shifted, c), none));
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(c, shift1), zero, 0x01);
+      c = _mm256_max_epi32(_mm256_add_epi32(shifted, c), none);
+
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(a, shift2), none, 0x03);
+      a = _mm256_max_epi32(a, _mm256_max_epi32(_mm256_add_epi32(shifted, c), none));
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(c, shift2), zero, 0x03);
+      c = _mm256_max_epi32(_mm256_add_epi32(shifted, c), none);
+
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(a, shift4), none, 0x0F);
+      a = _mm256_max_epi32(a, _mm256_max_epi32(_mm256_add_epi32(shifted, c), none));
+      shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(c, shift4), zero, 0x0F);
+      c = _mm256_max_epi32(_mm256_add_epi32(shifted, c), none);
+
+      __m256i result = _mm256_max_epi32(a, _mm256_max_epi32(_mm256_add_epi32(carry, c), none));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(score + j), result);
+      carry = _mm256_permutevar8x32_epi32(result, last);
+    }
+
+    dp_score left = _mm256_cvtsi256_si32(carry);
+    for (; j < columns; ++j) {
+      dp_score here = std::max(left, score[j]) + (cells[j] == CELL_GOLD);
+      if (cells[j] == CELL_ROCK) {
+        here = DP_SCORE_NONE;
+      }
+      score[j] = left = here;
+    }
+  }
+
+  // Four lanes per step.
+  __attribute__((target("sse4.1")))
+  void dyn_prog_score_row_sse41(const cell_kind* cells,
+                                dp_score* score,
+                                coordinate columns) {
+
+    const __m128i none = _mm_set1_epi32(DP_SCORE_NONE),
+                  rock_kind = _mm_set1_epi32(CELL_ROCK),
+                  gold_kind = _mm_set1_epi32(CELL_GOLD),
+                  one = _mm_set1_epi32(1);
+
+    __m128i carry = none;
+    coordinate j = 0;
+    for (; j + 4 <= columns; j += 4) {
+      int32_t packed;
+      std::memcpy(&packed, cells + j, sizeof(packed));
+      __m128i kinds = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed)),
+              rock = _mm_cmpeq_epi32(kinds, rock_kind),
+              gold = _mm_and_si128(_mm_cmpeq_epi32(kinds, gold_kind), one),
+              above = _mm_loadu_si128(reinterpret_cast<const __m128i*>(score + j));
+
+      __m128i a = _mm_blendv_epi8(_mm_add_epi32(above, gold), none, rock),
+              c = _mm_blendv_epi8(gold, none, rock), shifted;
+
+      // Byte shifts fill the low lanes with zero, which is right for c; a is
+      // filled with DP_SCORE_NONE by blending 16-bit halves.
+      shifted = _mm_blend_epi16(_mm_slli_si128(a, 4), none, 0x03);
+      a = _mm_max_epi32(a, _mm_max_epi32(_mm_add_epi32(shifted, c), none));
+      c = _mm_max_epi32(_mm_add_epi32(_mm_slli_si128(c, 4), c), none);
+
+      shifted = _mm_blend_epi16(_mm_slli_si128(a, 8), none, 0x0F);
+      a = _mm_max_epi32(a, _mm_max_epi32(_mm_add_epi32(shifted, c), none));
+      c = _mm_max_epi32(_mm_add_epi32(_mm_slli_si128(c, 8), c), none);
+
+      __m128i result = _mm_max_epi32(a, _mm_max_epi32(_mm_add_epi32(carry, c), none));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(score + j), result);
+      carry = _mm_shuffle_epi32(result, 0xFF);
+    }
+
+    dp_score left = _mm_cvtsi128_si32(carry);
+    for (; j < columns; ++j) {
+      dp_score here = std::max(left, score[j]) + (cells[j] == CELL_GOLD);
+      if (cells[j] == CELL_ROCK) {
+        here = DP_SCORE_NONE;
+      }
+      score[j] = left = here;
+    }
+  }
+
+#endif
+
+  // Return the fastest row kernel that this CPU supports.
+  dyn_prog_row_kernel dyn_prog_best_row_kernel() {
+#ifdef GNOMES_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return dyn_prog_score_row_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+      return dyn_prog_score_row_sse41;
+    }
+#endif
+    return dyn_prog_score_row_scalar;
+  }
+
+  // Compute one row of scores with the fastest available kernel.
+  void dyn_prog_score_row(const cell_kind* cells,
+                          dp_score* score,
+                          coordinate columns) {
+    static const dyn_prog_row_kernel kernel = dyn_prog_best_row_kernel();
+    kernel(cells, score, columns);
+  }
+
+}
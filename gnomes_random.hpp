@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// gnomes_random.hpp
+//
+// Fast generation of large random grids.
+//
+// grid::random places an exact number of gold and rock cells by shuffling
+// every position, which needs a 16-byte position per cell and one thread.
+// random_grid instead makes each cell gold or rock independently with the
+// given probabilities, so the counts are only expected values, but it needs
+// no memory beyond the grid itself and fills row blocks in parallel.
+//
+// Each cell's kind is a pure function of the seed and the cell's index,
+// computed with a counter-based generator (the SplitMix64 finalizer), so
+// the same seed gives the same grid on any number of threads.
+//
+// How to use:
+//
+//    ThreadPool pool;
+//    gnomes::grid map = gnomes::random_grid(20000, 20000, 0.2, 0.1, seed, pool);
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "gnomes_types.hpp"
+#include "thread_pool.hpp"
+
+namespace gnomes {
+
+  // Return a well-mixed 64-bit value for the given counter and seed: the
+  // output of SplitMix64 for the counter-th step from the seed.
+  uint64_t counter_random(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed + ((counter + 1) * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Number of rows each task of random_grid fills.
+  const coordinate RANDOM_GRID_BLOCK_ROWS = 64;
+
+  // Create a random grid with the given number of rows and columns, where
+  // each cell other than (0, 0) is gold with probability gold_probability,
+  // rock with probability rock_probability, and earth otherwise. (0, 0) is
+  // always earth. Blocks of rows are filled on the given pool's threads; the
+  // grid depends only on the seed.
+  //
+  // rows and columns must be positive, and the probabilities must be
+  // non-negative with a sum of at most 1.
+  grid random_grid(coordinate rows, coordinate columns,
+                   double gold_probability, double rock_probability,
+                   uint64_t seed, ThreadPool& pool) {
+
+    assert(rows > 0);
+    assert(columns > 0);
+    assert((gold_probability >= 0) && (rock_probability >= 0));
+    assert((gold_probability + rock_probability) <= 1);
+
+    // Compare the top 53 bits of each random value against thresholds, which
+    // is exact for probabilities that are multiples of 2^-53.
+    const double scale = double(uint64_t(1) << 53);
+    const uint64_t gold_below = uint64_t(gold_probability * scale),
+                   rock_below = uint64_t((gold_probability + rock_probability) * scale);
+
+    std::vector<cell_kind> cells(rows * columns);
+    const size_t blocks = (rows + RANDOM_GRID_BLOCK_ROWS - 1) / RANDOM_GRID_BLOCK_ROWS;
+    pool.parallel_for(blocks, [&](size_t block) {
+      const size_t first = block * RANDOM_GRID_BLOCK_ROWS * columns,
+                   last = std::min(rows, (block + 1) * RANDOM_GRID_BLOCK_ROWS) * columns;
+      cell_kind* out = cells.data();
+      for (size_t index = first; index < last; ++index) {
+        const uint64_t r = counter_random(seed, index) >> 11;
+        out[index] = (r < gold_below) ? CELL_GOLD
+                   : ((r < rock_below) ? CELL_ROCK : CELL_EARTH);
+      }
+    });
+    cells[0] = CELL_EARTH;
+
+    return grid(rows, columns, std::move(cells));
+  }
+
+  // As above, on the calling thread only.
+  grid random_grid(coordinate rows, coordinate columns,
+                   double gold_probability, double rock_probability,
+                   uint64_t seed) {
+    ThreadPool pool(1);
+    return random_grid(rows, columns, gold_probability, rock_probability, seed, pool);
+  }
+
+}
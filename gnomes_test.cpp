@@ -6,12 +6,17 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <cstdio>
+#include <fstream>
 #include <random>
+#include <sstream>
 
 #include "rubrictest.hpp"
 
 #include "gnomes_types.hpp"
 #include "gnomes_algs.hpp"
+#include "gnomes_io.hpp"
+#include "gnomes_random.hpp"
 
 int main() {
 
@@ -79,6 +84,57 @@ int main() {
          TEST_EQUAL("correct", maze_solution, greedy_gnomes_exhaustive(maze));
 		   });
 
+  rubric.criterion("exhaustive search - pruned", 1,
+		   [&]() {
+         TEST_EQUAL("empty4", empty4_solution, greedy_gnomes_exhaustive_pruned(empty4));
+         TEST_EQUAL("horizontal", horizontal_solution, greedy_gnomes_exhaustive_pruned(horizontal));
+         TEST_EQUAL("vertical", vertical_solution, greedy_gnomes_exhaustive_pruned(vertical));
+         TEST_EQUAL("maze", maze_solution, greedy_gnomes_exhaustive_pruned(maze));
+         TEST_EQUAL("all_gold total gold", 6, greedy_gnomes_exhaustive_pruned(all_gold).total_gold());
+         TEST_EQUAL("medium", greedy_gnomes_dyn_prog(medium_random).total_gold(),
+                    greedy_gnomes_exhaustive_pruned(medium_random).total_gold());
+         TEST_EQUAL("small_random", greedy_gnomes_exhaustive(small_random).total_gold(),
+                    greedy_gnomes_exhaustive_pruned(small_random).total_gold());
+		   });
+
+  rubric.criterion("exhaustive search - parallel", 1,
+		   [&]() {
+         ThreadPool pool(3);
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze, &small_random}) {
+           auto expected = gnomes::greedy_gnomes_exhaustive(*setting);
+           auto output = gnomes::greedy_gnomes_exhaustive_parallel(*setting, pool, 3);
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+		   });
+
+  rubric.criterion("exhaustive search - incremental", 1,
+		   [&]() {
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze, &small_random}) {
+           auto expected = gnomes::greedy_gnomes_exhaustive(*setting);
+           auto output = gnomes::greedy_gnomes_exhaustive_incremental(*setting);
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+		   });
+
+  rubric.criterion("exhaustive search - live region", 1,
+		   [&]() {
+         auto live = gnomes::find_live_region(maze);
+         TEST_EQUAL("maze live rows", 4, live.live_rows);
+         TEST_EQUAL("maze row 1 first", 1, live.first[1]);
+         TEST_EQUAL("maze row 1 last", 3, live.last[1]);
+         TEST_EQUAL("maze max steps", 6, live.max_steps);
+         TEST_EQUAL("maze envelope cells", 7, live.envelope_cells);
+         TEST_TRUE("empty4 has nothing live", gnomes::find_live_region(empty4).empty());
+         TEST_EQUAL("empty4", empty4_solution, greedy_gnomes_exhaustive_live(empty4));
+         TEST_EQUAL("horizontal", horizontal_solution, greedy_gnomes_exhaustive_live(horizontal));
+         TEST_EQUAL("vertical", vertical_solution, greedy_gnomes_exhaustive_live(vertical));
+         TEST_EQUAL("maze", maze_solution, greedy_gnomes_exhaustive_live(maze));
+         TEST_EQUAL("small_random", greedy_gnomes_exhaustive(small_random),
+                    greedy_gnomes_exhaustive_live(small_random));
+		   });
+
   rubric.criterion("dynamic programming - simple cases", 4,
 		   [&]() {
          TEST_EQUAL("empty2", empty2_solution, greedy_gnomes_dyn_prog(empty2));
@@ -109,6 +165,371 @@ int main() {
          TEST_EQUAL("large", 9, large_output.total_gold());
 		   });
 
+  rubric.criterion("dynamic programming - live region", 1,
+		   [&]() {
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze,
+                               &small_random, &medium_random, &large_random}) {
+           TEST_EQUAL("same path", gnomes::greedy_gnomes_dyn_prog(*setting),
+                      gnomes::greedy_gnomes_dyn_prog_live(*setting));
+         }
+		   });
+
+  rubric.criterion("dynamic programming - gold only", 1,
+		   [&]() {
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze,
+                               &small_random, &medium_random, &large_random}) {
+           auto expected = gnomes::greedy_gnomes_dyn_prog(*setting);
+           auto output = gnomes::greedy_gnomes_dyn_prog_gold(*setting);
+           TEST_EQUAL("total gold", expected.total_gold(), output.total_gold);
+           TEST_EQUAL("final row", expected.final_row(), output.final_row);
+           TEST_EQUAL("final column", expected.final_column(), output.final_column);
+         }
+		   });
+
+  rubric.criterion("dynamic programming - linear space", 1,
+		   [&]() {
+         TEST_EQUAL("horizontal", horizontal_solution, greedy_gnomes_dyn_prog_linear_space(horizontal));
+         TEST_EQUAL("vertical", vertical_solution, greedy_gnomes_dyn_prog_linear_space(vertical));
+         TEST_EQUAL("maze", maze_solution, greedy_gnomes_dyn_prog_linear_space(maze));
+         for (auto* setting : {&all_gold, &small_random, &medium_random, &large_random}) {
+           auto expected = gnomes::greedy_gnomes_dyn_prog(*setting);
+           auto output = gnomes::greedy_gnomes_dyn_prog_linear_space(*setting);
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+		   });
+
+  rubric.criterion("dynamic programming - wavefront", 1,
+		   [&]() {
+         ThreadPool pool(4);
+         for (gnomes::coordinate tile_size = 1; tile_size <= 7; ++tile_size) {
+           for (auto* setting : {&empty2, &empty4, &horizontal, &vertical, &all_gold, &maze,
+                                 &small_random, &medium_random, &large_random}) {
+             auto expected = gnomes::greedy_gnomes_dyn_prog(*setting);
+             auto output = gnomes::greedy_gnomes_dyn_prog_wavefront(*setting, pool, tile_size);
+             TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+             TEST_EQUAL("same path", expected, output);
+           }
+         }
+		   });
+
+  rubric.criterion("dynamic programming - batch", 1,
+		   [&]() {
+         ThreadPool pool(3);
+         const gnomes::grid settings[] = {empty2, empty4, horizontal, vertical, all_gold, maze,
+                                          small_random, medium_random, large_random,
+                                          maze, empty2, large_random, all_gold};
+         const size_t count = sizeof(settings) / sizeof(settings[0]);
+         auto outputs = gnomes::greedy_gnomes_dyn_prog_batch(settings, settings + count, pool);
+         TEST_EQUAL("count", count, outputs.size());
+         for (size_t i = 0; i < count; ++i) {
+           TEST_EQUAL("same path", gnomes::greedy_gnomes_dyn_prog(settings[i]), outputs[i]);
+         }
+         TEST_EQUAL("empty batch", 0, gnomes::greedy_gnomes_dyn_prog_batch(settings, settings, pool).size());
+		   });
+
+  rubric.criterion("dynamic programming - incremental", 1,
+		   [&]() {
+         gnomes::grid setting = medium_random;
+         gnomes::dyn_prog_incremental solver(setting);
+         std::mt19937 edits(335);
+         for (unsigned i = 0; i < 200; ++i) {
+           gnomes::coordinate row = edits() % setting.rows(),
+                              column = edits() % setting.columns();
+           if (row == 0 && column == 0) {
+             continue;
+           }
+           auto kind = gnomes::cell_kind(edits() % 3);
+           setting.set(row, column, kind);
+           solver.set(row, column, kind);
+           auto expected = gnomes::greedy_gnomes_dyn_prog(setting);
+           auto output = solver.best_path();
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+		   });
+
+  rubric.criterion("dynamic programming - top k", 1,
+		   [&]() {
+         auto maze_top = gnomes::greedy_gnomes_dyn_prog_top_k(maze, 3);
+         TEST_EQUAL("maze best", maze_solution, maze_top[0]);
+         TEST_EQUAL("maze count", 3, maze_top.size());
+         TEST_EQUAL("maze second", 0, maze_top[1].total_gold());
+
+         auto all_gold_top = gnomes::greedy_gnomes_dyn_prog_top_k(all_gold, 30);
+         TEST_EQUAL("all_gold count", 30, all_gold_top.size());
+         TEST_EQUAL("all_gold 20 best", 6, all_gold_top[19].total_gold());
+         TEST_EQUAL("all_gold 21st", 5, all_gold_top[20].total_gold());
+
+         auto large_top = gnomes::greedy_gnomes_dyn_prog_top_k(large_random, 10);
+         TEST_EQUAL("large best", gnomes::greedy_gnomes_dyn_prog(large_random), large_top[0]);
+         for (size_t i = 1; i < large_top.size(); ++i) {
+           TEST_GE("decreasing", large_top[i - 1].total_gold(), large_top[i].total_gold());
+           TEST_FALSE("distinct", large_top[i - 1] == large_top[i]);
+         }
+		   });
+
+  rubric.criterion("dynamic programming - weighted", 1,
+		   [&]() {
+         // One valuable nugget beats two ordinary ones.
+         gnomes::weighted_grid<uint32_t> nuggets(4, 4);
+         nuggets.set(0, 1, gnomes::CELL_GOLD, 1);
+         nuggets.set(0, 2, gnomes::CELL_GOLD, 1);
+         nuggets.set(3, 0, gnomes::CELL_GOLD, 5);
+         auto output = gnomes::greedy_gnomes_dyn_prog_weighted(nuggets);
+         TEST_EQUAL("value", 5, output.total_value);
+         TEST_EQUAL("path", gnomes::path(nuggets.terrain(), {D, D, D}), output.best);
+
+         // Unit weights give the unweighted answer.
+         gnomes::weighted_grid<uint16_t> unit(large_random);
+         auto unit_output = gnomes::greedy_gnomes_dyn_prog_weighted(unit);
+         TEST_EQUAL("unit path", gnomes::greedy_gnomes_dyn_prog(large_random), unit_output.best);
+
+         // Tie-break policies.
+         gnomes::weighted_grid<uint32_t> open(empty2);
+         auto down = gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_prefer_down>(open);
+         auto right = gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_prefer_right>(open);
+         TEST_EQUAL("prefer down", empty2_solution, down.best);
+         TEST_EQUAL("prefer right", empty2_solution, right.best);
+         gnomes::weighted_grid<uint32_t> corner(2, 2);
+         corner.set(1, 1, gnomes::CELL_GOLD, 3);
+         TEST_EQUAL("prefer down corner", gnomes::path(corner.terrain(), {R, D}),
+                    gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_prefer_down>(corner).best);
+         TEST_EQUAL("prefer right corner", gnomes::path(corner.terrain(), {D, R}),
+                    gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_prefer_right>(corner).best);
+         gnomes::weighted_grid<uint32_t> far(2, 4);
+         far.set(0, 3, gnomes::CELL_GOLD, 2);
+         far.set(1, 0, gnomes::CELL_GOLD, 2);
+         TEST_EQUAL("shortest", gnomes::path(far.terrain(), {D}),
+                    gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_shortest>(far).best);
+         TEST_EQUAL("first end", gnomes::path(far.terrain(), {R, R, R}),
+                    gnomes::greedy_gnomes_dyn_prog_weighted<gnomes::tie_prefer_down>(far).best);
+
+         // Gold walled off from (0, 0) stays unreachable however much it is
+         // worth in total.
+         gnomes::weighted_grid<uint16_t> walled(2, 20000);
+         for (gnomes::coordinate r = 0; r < 2; ++r) {
+           for (gnomes::coordinate c = 0; c < 20000; ++c) {
+             if (!(r == 0 && c == 0)) {
+               walled.set(r, c, gnomes::CELL_GOLD, 65535);
+             }
+           }
+         }
+         walled.set(0, 1, gnomes::CELL_ROCK);
+         walled.set(1, 0, gnomes::CELL_ROCK);
+         auto walled_output = gnomes::greedy_gnomes_dyn_prog_weighted(walled);
+         TEST_EQUAL("walled value", 0, walled_output.total_value);
+         TEST_EQUAL("walled path", gnomes::path(walled.terrain()), walled_output.best);
+		   });
+
+  rubric.criterion("dynamic programming - fixed sizes", 1,
+		   [&]() {
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze,
+                               &small_random, &medium_random, &large_random}) {
+           auto expected = gnomes::greedy_gnomes_dyn_prog(*setting);
+           auto output = gnomes::greedy_gnomes_dyn_prog_small(*setting);
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+         // Grids of exactly each specialized size, with gold to collect.
+         for (uint64_t seed = 1; seed <= 5; ++seed) {
+           gnomes::grid grid8 = gnomes::random_grid(8, 8, 0.2, 0.1, seed),
+                        grid12 = gnomes::random_grid(12, 24, 0.2, 0.1, seed),
+                        grid16 = gnomes::random_grid(16, 16, 0.2, 0.1, seed);
+           auto expected8 = gnomes::greedy_gnomes_dyn_prog(grid8),
+                expected12 = gnomes::greedy_gnomes_dyn_prog(grid12),
+                expected16 = gnomes::greedy_gnomes_dyn_prog(grid16);
+           TEST_GT("8x8 has gold", expected8.total_gold(), 0);
+           TEST_GT("12x24 has gold", expected12.total_gold(), 0);
+           TEST_GT("16x16 has gold", expected16.total_gold(), 0);
+           TEST_EQUAL("8x8 small", expected8, gnomes::greedy_gnomes_dyn_prog_small(grid8));
+           TEST_EQUAL("12x24 small", expected12, gnomes::greedy_gnomes_dyn_prog_small(grid12));
+           TEST_EQUAL("16x16 small", expected16, gnomes::greedy_gnomes_dyn_prog_small(grid16));
+           TEST_EQUAL("8x8 fixed", expected8, (gnomes::greedy_gnomes_dyn_prog_fixed<8, 8>(grid8)));
+           TEST_EQUAL("12x24 fixed", expected12, (gnomes::greedy_gnomes_dyn_prog_fixed<12, 24>(grid12)));
+           TEST_EQUAL("16x16 fixed", expected16, (gnomes::greedy_gnomes_dyn_prog_fixed<16, 16>(grid16)));
+         }
+		   });
+
+  rubric.criterion("dynamic programming - bitboard", 1,
+		   [&]() {
+         TEST_EQUAL("maze reachable row 1", 0x6, gnomes::bitboard_reachable(maze)[1]);
+         TEST_EQUAL("maze reachable row 3", 0x8, gnomes::bitboard_reachable(maze)[3]);
+         for (auto* setting : {&empty4, &horizontal, &vertical, &all_gold, &maze,
+                               &small_random, &medium_random}) {
+           auto expected = gnomes::greedy_gnomes_dyn_prog(*setting);
+           auto output = gnomes::greedy_gnomes_dyn_prog_bitboard(*setting);
+           TEST_EQUAL("same length", expected.steps().size(), output.steps().size());
+           TEST_EQUAL("same path", expected, output);
+         }
+		   });
+
+  rubric.criterion("dynamic programming - row kernels", 1,
+		   [&]() {
+         std::vector<gnomes::dyn_prog_row_kernel> kernels;
+#ifdef GNOMES_X86_KERNELS
+         __builtin_cpu_init();
+         if (__builtin_cpu_supports("sse4.1")) {
+           kernels.push_back(gnomes::dyn_prog_score_row_sse41);
+         }
+         if (__builtin_cpu_supports("avx2")) {
+           kernels.push_back(gnomes::dyn_prog_score_row_avx2);
+         }
+#endif
+         kernels.push_back(gnomes::dyn_prog_best_row_kernel());
+         for (gnomes::coordinate columns : {1, 3, 5, 7, 9, 13, 17, 31, 33, 67}) {
+           for (double rock : {0.1, 0.4, 0.7}) {
+             gnomes::grid setting = gnomes::random_grid(12, columns, 0.2, rock, columns);
+             for (auto kernel : kernels) {
+               std::vector<gnomes::dp_score> expected(columns, gnomes::DP_SCORE_NONE),
+                                             output(columns, gnomes::DP_SCORE_NONE);
+               expected[0] = output[0] = 0;
+               for (gnomes::coordinate i = 0; i < setting.rows(); ++i) {
+                 gnomes::dyn_prog_score_row_scalar(setting.row_begin(i), expected.data(), columns);
+                 kernel(setting.row_begin(i), output.data(), columns);
+                 for (gnomes::coordinate j = 0; j < columns; ++j) {
+                   if (expected[j] >= 0) {
+                     TEST_EQUAL("same score", expected[j], output[j]);
+                   } else {
+                     TEST_TRUE("unreachable", output[j] < 0);
+                   }
+                 }
+               }
+             }
+           }
+         }
+		   });
+
+  rubric.criterion("grid files", 1,
+		   [&]() {
+         const std::string filename = "gnomes_test_grid.bin";
+         gnomes::mapped_grid_file file;
+         TEST_FALSE("missing file", file.open("gnomes_test_no_such_file.bin"));
+
+         TEST_TRUE("write grid", gnomes::write_grid_file(filename, medium_random));
+         TEST_TRUE("open", file.open(filename));
+         TEST_EQUAL("rows", medium_random.rows(), file.rows());
+         TEST_EQUAL("columns", medium_random.columns(), file.columns());
+         bool same_cells = true;
+         for (gnomes::coordinate r = 0; r < medium_random.rows(); ++r) {
+           for (gnomes::coordinate c = 0; c < medium_random.columns(); ++c) {
+             same_cells = same_cells && (medium_random.get(r, c) == file.view().get(r, c));
+           }
+         }
+         TEST_TRUE("same cells", same_cells);
+         auto expected = gnomes::greedy_gnomes_dyn_prog(medium_random);
+         TEST_EQUAL("gold from file", expected.total_gold(),
+                    gnomes::greedy_gnomes_dyn_prog_gold(file.view()).total_gold);
+         TEST_EQUAL("path from unpacked file", expected,
+                    gnomes::greedy_gnomes_dyn_prog(file.view().unpack()));
+
+         gnomes::packed_grid packed(maze);
+         TEST_TRUE("write packed grid", gnomes::write_grid_file(filename, packed.view()));
+         TEST_TRUE("reopen", file.open(filename));
+         TEST_EQUAL("maze from file", maze_solution,
+                    gnomes::greedy_gnomes_dyn_prog(file.view().unpack()));
+         file.close();
+
+         std::ofstream(filename, std::ios::binary) << "not a grid file";
+         TEST_FALSE("bad magic", file.open(filename));
+         std::remove(filename.c_str());
+		   });
+
+  rubric.criterion("grid text", 1,
+		   [&]() {
+         std::string text;
+         for (auto& line : large_random.printable()) {
+           text += line + "\n";
+         }
+         std::istringstream in(text);
+         gnomes::grid parsed(1, 1);
+         TEST_TRUE("read", gnomes::read_grid_text(in, parsed));
+         TEST_EQUAL("same rows", large_random.printable(), parsed.printable());
+
+         // Tiny chunks split rows across reads.
+         std::istringstream chunked(text);
+         gnomes::grid_text_reader reader(chunked, 7);
+         const gnomes::cell_kind* row = reader.next_row();
+         gnomes::dyn_prog_row_solver solver(reader.columns());
+         for (; row != nullptr; row = reader.next_row()) {
+           solver.add_row(row);
+         }
+         TEST_FALSE("no error", reader.failed());
+         TEST_EQUAL("all rows", large_random.rows(), reader.rows());
+         TEST_EQUAL("all bytes", text.size(), reader.bytes_read());
+         TEST_EQUAL("streamed gold", greedy_gnomes_dyn_prog(large_random).total_gold(),
+                    solver.summary().total_gold);
+
+         std::istringstream crlf("..X\r\n.g.\r\n\n.Xg");
+         TEST_TRUE("crlf and no final newline", gnomes::read_grid_text(crlf, parsed));
+         TEST_EQUAL("crlf rows", 3, parsed.rows());
+         TEST_EQUAL("last row", gnomes::CELL_GOLD, parsed.get(2, 2));
+
+         std::string error;
+         std::istringstream ragged("...\n..\n");
+         TEST_FALSE("ragged", gnomes::read_grid_text(ragged, parsed, &error));
+         TEST_FALSE("ragged error", error.empty());
+         std::istringstream bad(".a.\n");
+         TEST_FALSE("bad character", gnomes::read_grid_text(bad, parsed));
+         std::istringstream empty("");
+         TEST_FALSE("empty", gnomes::read_grid_text(empty, parsed));
+		   });
+
+  rubric.criterion("random grid generator", 1,
+		   [&]() {
+         ThreadPool one(1), four(4);
+         auto serial = gnomes::random_grid(300, 200, 0.2, 0.1, 42, one),
+              parallel = gnomes::random_grid(300, 200, 0.2, 0.1, 42, four),
+              other_seed = gnomes::random_grid(300, 200, 0.2, 0.1, 43, four);
+         TEST_EQUAL("same for any thread count", serial.printable(), parallel.printable());
+         TEST_NOT_EQUAL("seed matters", serial.printable(), other_seed.printable());
+         TEST_EQUAL("start is earth", gnomes::CELL_EARTH, serial.get(0, 0));
+         unsigned gold = 0, rock = 0;
+         for (gnomes::coordinate r = 0; r < serial.rows(); ++r) {
+           for (gnomes::coordinate c = 0; c < serial.columns(); ++c) {
+             gold += (serial.get(r, c) == gnomes::CELL_GOLD);
+             rock += (serial.get(r, c) == gnomes::CELL_ROCK);
+           }
+         }
+         TEST_TRUE("about 20% gold", (gold > 11400) && (gold < 12600));
+         TEST_TRUE("about 10% rock", (rock > 5600) && (rock < 6400));
+		   });
+
+  rubric.criterion("solver stats", 1,
+		   [&]() {
+         auto& stats = gnomes::solver_stats::current();
+         stats.reset();
+         greedy_gnomes_exhaustive(maze);
+         if (gnomes::solver_stats::enabled) {
+           TEST_EQUAL("candidates", 127, stats.candidates_generated);
+           TEST_TRUE("some pruned", stats.candidates_pruned > 0);
+           TEST_TRUE("walks visit cells", stats.cells_visited > 0);
+           TEST_EQUAL("result built and copied", 2, stats.paths_copied);
+         } else {
+           TEST_EQUAL("disabled", 0, stats.candidates_generated + stats.paths_copied);
+         }
+
+         stats.reset();
+         gnomes::solver_context context;
+         greedy_gnomes_dyn_prog(maze, context);
+         if (gnomes::solver_stats::enabled) {
+           TEST_EQUAL("cells", 16, stats.cells_visited);
+           TEST_EQUAL("rock cells", 9, stats.cells_unreachable);
+           TEST_EQUAL("nothing skipped", 0, stats.cells_skipped);
+           TEST_EQUAL("one path", 1, stats.paths_copied);
+           TEST_TRUE("tables allocated", stats.bytes_allocated >= 16);
+         } else {
+           TEST_EQUAL("disabled", 0, stats.cells_visited + stats.bytes_allocated);
+         }
+
+         stats.reset();
+         greedy_gnomes_dyn_prog_live(maze, context);
+         if (gnomes::solver_stats::enabled) {
+           TEST_EQUAL("envelope cells", 7, stats.cells_visited);
+           TEST_EQUAL("skipped cells", 9, stats.cells_skipped);
+         }
+		   });
+
   rubric.criterion("stress test", 2,
 		   [&]() {
          const gnomes::coordinate ROWS = 5,
@@ -125,6 +546,9 @@ int main() {
            TEST_EQUAL("random grid with " + std::to_string(columns) + " columns",
                       gnomes::greedy_gnomes_exhaustive(setting).total_gold(),
                       gnomes::greedy_gnomes_dyn_prog(setting).total_gold());
+           TEST_EQUAL("pruned random grid with " + std::to_string(columns) + " columns",
+                      gnomes::greedy_gnomes_exhaustive(setting).total_gold(),
+                      gnomes::greedy_gnomes_exhaustive_pruned(setting).total_gold());
          }
 		   });
 
@@ -7,25 +7,727 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <random>
 #include <iostream>
+#include <sstream>
+#include <string>
 
+#include "alloc_counter.hpp"
+#include "benchmark.hpp"
 #include "timer.hpp"
 
 #include "gnomes_algs.hpp"
+#include "gnomes_io.hpp"
+#include "gnomes_random.hpp"
+
+const size_t EXHAUSTIVE_SEARCH_MAX_N = 30,
+             PRUNED_SEARCH_MAX_N = 45;
 
 void print_bar() {
   std::cout << std::string(79, '-') << std::endl;
 }
 
-int main() {
+// Make a random square-ish input of size n, with 20% gold and 10% rock.
+gnomes::grid random_input(size_t n, std::mt19937& gen) {
+  gnomes::coordinate rows = n / 2,
+                     columns = n - rows;
+  unsigned cells = rows * columns;
+  return gnomes::grid::random(rows, columns, cells / 5, cells / 10, gen);
+}
+
+// Time the wavefront dynamic programming algorithm on one large grid with
+// 1, 2, 4, ... threads, up to the number of hardware threads.
+int wavefront_scaling(size_t n, gnomes::coordinate tile_size) {
+
+  std::mt19937 gen;
+  gnomes::grid input = random_input(n, gen);
+
+  print_bar();
+  std::cout << "wavefront scaling, n=" << n
+            << ", rows=" << input.rows()
+            << ", columns=" << input.columns()
+            << ", tile size=" << tile_size
+            << std::endl;
+
+  Timer timer;
+  auto serial_output = greedy_gnomes_dyn_prog(input);
+  double serial = timer.elapsed();
+  std::cout << "serial elapsed time=" << serial << " seconds" << std::endl;
+
+  const size_t max_threads = ThreadPool::hardware_threads();
+  for (size_t threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+    ThreadPool pool(threads);
+    timer.reset();
+    auto output = greedy_gnomes_dyn_prog_wavefront(input, pool, tile_size);
+    double elapsed = timer.elapsed();
+    if (!(output == serial_output)) {
+      std::cerr << "wavefront path differs from serial with " << threads << " threads" << std::endl;
+      return 1;
+    }
+    std::cout << "threads=" << threads
+              << " elapsed time=" << elapsed << " seconds"
+              << " speedup=" << (serial / elapsed)
+              << std::endl;
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Time each available row kernel against the scalar loop by repeatedly
+// scoring every row of a grid with the given number of columns.
+int kernel_benchmark(gnomes::coordinate columns) {
+
+  const gnomes::coordinate rows = 256;
+  const unsigned repeats = 20;
+
+  std::mt19937 gen;
+  gnomes::grid input = gnomes::grid::random(rows, columns,
+                                            (rows * columns) / 5,
+                                            (rows * columns) / 10, gen);
+
+  struct kernel {
+    const char* name;
+    gnomes::dyn_prog_row_kernel function;
+  };
+  std::vector<kernel> kernels{{"scalar", gnomes::dyn_prog_score_row_scalar}};
+#ifdef GNOMES_X86_KERNELS
+  if (__builtin_cpu_supports("sse4.1")) {
+    kernels.push_back({"sse4.1", gnomes::dyn_prog_score_row_sse41});
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back({"avx2", gnomes::dyn_prog_score_row_avx2});
+  }
+#endif
+
+  print_bar();
+  std::cout << "row kernels, " << rows << " rows x " << columns
+            << " columns, " << repeats << " repeats" << std::endl;
+
+  double scalar = 0;
+  std::vector<gnomes::dp_score> reference;
+  for (auto& k : kernels) {
+    std::vector<gnomes::dp_score> score(columns);
+    Timer timer;
+    for (unsigned r = 0; r < repeats; ++r) {
+      std::fill(score.begin(), score.end(), gnomes::DP_SCORE_NONE);
+      score[0] = 0;
+      for (gnomes::coordinate i = 0; i < rows; ++i) {
+        k.function(input.row_begin(i), score.data(), columns);
+      }
+    }
+    double elapsed = timer.elapsed();
+    if (scalar == 0) {
+      scalar = elapsed;
+      reference = score;
+    }
+    // Scores of unreachable cells may differ between kernels.
+    for (gnomes::coordinate j = 0; j < columns; ++j) {
+      if ((reference[j] >= 0) ? (score[j] != reference[j]) : (score[j] >= 0)) {
+        std::cerr << k.name << " kernel disagrees with scalar at column " << j << std::endl;
+        return 1;
+      }
+    }
+    std::cout << k.name
+              << " best=" << *std::max_element(score.begin(), score.end())
+              << " elapsed time=" << elapsed << " seconds"
+              << " cells/ns=" << ((double(rows) * columns * repeats) / (elapsed * 1e9))
+              << " speedup=" << (scalar / elapsed)
+              << std::endl;
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Count the heap allocations made while scoring every exhaustive search
+// candidate of one grid, first by building each candidate path and then
+// with the allocation-free evaluation, and time both.
+int allocation_benchmark(size_t n) {
+
+  std::mt19937 gen;
+  gnomes::grid input = random_input(n, gen);
+  const size_t max_steps = input.rows() + input.columns() - 2;
+
+  print_bar();
+  std::cout << "exhaustive candidate evaluation, n=" << n << std::endl;
+
+  for (bool build_paths : {true, false}) {
+    unsigned total = 0;
+    size_t candidates = 0,
+           before = AllocCounter::allocations();
+    Timer timer;
+    for (size_t len = 0; len <= max_steps; len++) {
+      for (uint64_t bits = 0; bits < (uint64_t(1) << len); bits++) {
+        if (build_paths) {
+          total += gnomes::exhaustive_candidate(input, len, bits).total_gold();
+        } else {
+          total += gnomes::exhaustive_candidate_gold(input, len, bits);
+        }
+        ++candidates;
+      }
+    }
+    double elapsed = timer.elapsed();
+    std::cout << (build_paths ? "path objects:  " : "allocation-free:")
+              << " candidates=" << candidates
+              << " allocations=" << (AllocCounter::allocations() - before)
+              << " elapsed time=" << elapsed << " seconds"
+              << " (checksum " << total << ")"
+              << std::endl;
+  }
+
+  size_t before = AllocCounter::allocations();
+  greedy_gnomes_exhaustive(input);
+  std::cout << "greedy_gnomes_exhaustive allocations="
+            << (AllocCounter::allocations() - before) << std::endl;
+
+  print_bar();
+  return 0;
+}
+
+// Compare solving many grids one call at a time against the batch solver,
+// and report throughput in grids per second.
+int batch_benchmark(size_t count, size_t n) {
+
+  std::mt19937 gen;
+  std::vector<gnomes::grid> inputs;
+  inputs.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    inputs.push_back(random_input(n, gen));
+  }
+
+  print_bar();
+  std::cout << "batch dynamic programming, " << count
+            << " grids, n=" << n << std::endl;
+
+  Timer timer;
+  unsigned single_gold = 0;
+  size_t before = AllocCounter::allocations();
+  for (auto& input : inputs) {
+    single_gold += gnomes::greedy_gnomes_dyn_prog(input).total_gold();
+  }
+  double elapsed = timer.elapsed();
+  std::cout << "one call per grid: elapsed time=" << elapsed << " seconds"
+            << " grids/sec=" << (count / elapsed)
+            << " allocations=" << (AllocCounter::allocations() - before)
+            << std::endl;
+
+  ThreadPool pool;
+  timer.reset();
+  before = AllocCounter::allocations();
+  auto outputs = gnomes::greedy_gnomes_dyn_prog_batch(inputs.data(),
+                                                      inputs.data() + count,
+                                                      pool);
+  elapsed = timer.elapsed();
+  unsigned batch_gold = 0;
+  for (auto& output : outputs) {
+    batch_gold += output.total_gold();
+  }
+  if (batch_gold != single_gold) {
+    std::cerr << "batch found " << batch_gold << " gold, one call per grid "
+              << single_gold << std::endl;
+    return 1;
+  }
+  std::cout << "batch, threads=" << pool.size()
+            << ": elapsed time=" << elapsed << " seconds"
+            << " grids/sec=" << (count / elapsed)
+            << " allocations=" << (AllocCounter::allocations() - before)
+            << std::endl;
+
+  print_bar();
+  return 0;
+}
+
+// Solve a series of same-sized grids with one solver_context per algorithm,
+// and count the heap allocations made after the first (warm-up) grid.
+int context_benchmark(size_t count, size_t n) {
+
+  std::mt19937 gen;
+  std::vector<gnomes::grid> inputs;
+  for (size_t i = 0; i < count; ++i) {
+    inputs.push_back(random_input(n, gen));
+  }
+
+  print_bar();
+  std::cout << "solver contexts, " << count << " grids, n=" << n << std::endl;
 
-  const size_t EXHAUSTIVE_SEARCH_MAX_N = 30;
+  for (bool exhaustive : {false, true}) {
+    if (exhaustive && (n > EXHAUSTIVE_SEARCH_MAX_N)) {
+      std::cout << "(n too large, skipping exhaustive search)" << std::endl;
+      continue;
+    }
 
-  const size_t n = 15;
+    // Warm up by solving the first grid twice: the first solve sizes the
+    // arena's blocks, and the second merges them into one.
+    gnomes::solver_context context;
+    size_t before = AllocCounter::allocations();
+    for (unsigned i = 0; i < 2; ++i) {
+      exhaustive ? greedy_gnomes_exhaustive(inputs[0], context)
+                 : greedy_gnomes_dyn_prog(inputs[0], context);
+    }
+    size_t warm_up = AllocCounter::allocations() - before;
+
+    before = AllocCounter::allocations();
+    unsigned gold = 0;
+    Timer timer;
+    for (auto& input : inputs) {
+      gold += (exhaustive ? greedy_gnomes_exhaustive(input, context)
+                          : greedy_gnomes_dyn_prog(input, context)).total_gold();
+    }
+    double elapsed = timer.elapsed();
+    std::cout << (exhaustive ? "exhaustive search:  " : "dynamic programming:")
+              << " warm-up allocations=" << warm_up
+              << " later allocations=" << (AllocCounter::allocations() - before)
+              << " arena bytes=" << context.memory().used()
+              << " elapsed time=" << elapsed << " seconds"
+              << " (checksum " << gold << ")"
+              << std::endl;
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Apply random single-cell edits to one grid, comparing a full re-solve
+// after each edit against the incremental solver.
+int incremental_benchmark(size_t n, size_t edits) {
+
+  std::mt19937 gen;
+  gnomes::grid input = random_input(n, gen);
+
+  print_bar();
+  std::cout << "incremental dynamic programming, n=" << n
+            << ", rows=" << input.rows()
+            << ", columns=" << input.columns()
+            << ", " << edits << " edits" << std::endl;
+
+  std::vector<gnomes::coordinate> rows(edits), columns(edits);
+  std::vector<gnomes::cell_kind> kinds(edits);
+  for (size_t i = 0; i < edits; ++i) {
+    do {
+      rows[i] = gen() % input.rows();
+      columns[i] = gen() % input.columns();
+    } while (rows[i] == 0 && columns[i] == 0);
+    kinds[i] = gnomes::cell_kind(gen() % 3);
+  }
+
+  gnomes::grid full = input;
+  gnomes::solver_context context;
+  unsigned full_gold = 0;
+  Timer timer;
+  for (size_t i = 0; i < edits; ++i) {
+    full.set(rows[i], columns[i], kinds[i]);
+    full_gold += greedy_gnomes_dyn_prog(full, context).total_gold();
+  }
+  double elapsed = timer.elapsed();
+  std::cout << "full re-solve: elapsed time=" << elapsed << " seconds" << std::endl;
+
+  gnomes::dyn_prog_incremental solver(input);
+  size_t initial = solver.cells_recomputed();
+  unsigned incremental_gold = 0;
+  timer.reset();
+  for (size_t i = 0; i < edits; ++i) {
+    solver.set(rows[i], columns[i], kinds[i]);
+    incremental_gold += solver.best_path().total_gold();
+  }
+  elapsed = timer.elapsed();
+  if (incremental_gold != full_gold) {
+    std::cerr << "incremental found " << incremental_gold << " gold, full re-solve "
+              << full_gold << std::endl;
+    return 1;
+  }
+  std::cout << "incremental:   elapsed time=" << elapsed << " seconds"
+            << " cells recomputed per edit="
+            << (double(solver.cells_recomputed() - initial) / edits)
+            << " of " << (input.rows() * input.columns())
+            << std::endl;
+
+  print_bar();
+  return 0;
+}
+
+// Time the compile-time specialized solvers against the generic dynamic
+// programming algorithm on many grids of each specialized size.
+int fixed_size_benchmark(size_t count) {
+
+  print_bar();
+  std::cout << "fixed-size dynamic programming, " << count << " grids per size" << std::endl;
+
+  const std::pair<gnomes::coordinate, gnomes::coordinate> sizes[] = {
+    {4, 4}, {4, 5}, {8, 8}, {12, 24}, {16, 16}
+  };
+
+  std::mt19937 gen;
+  for (auto& size : sizes) {
+    std::vector<gnomes::grid> inputs;
+    unsigned cells = size.first * size.second;
+    for (size_t i = 0; i < count; ++i) {
+      inputs.push_back(gnomes::grid::random(size.first, size.second,
+                                            cells / 5, cells / 10, gen));
+    }
+
+    gnomes::solver_context context;
+    unsigned generic_gold = 0, fixed_gold = 0;
+    Timer timer;
+    for (auto& input : inputs) {
+      generic_gold += greedy_gnomes_dyn_prog(input, context).total_gold();
+    }
+    double generic = timer.elapsed();
+
+    timer.reset();
+    for (auto& input : inputs) {
+      fixed_gold += greedy_gnomes_dyn_prog_small(input).total_gold();
+    }
+    double fixed = timer.elapsed();
+    if (generic_gold != fixed_gold) {
+      std::cerr << size.first << "x" << size.second << " fixed found " << fixed_gold
+                << " gold, generic " << generic_gold << std::endl;
+      return 1;
+    }
+
+    std::cout << size.first << "x" << size.second
+              << ": generic=" << generic << " seconds"
+              << " fixed=" << fixed << " seconds"
+              << " speedup=" << (generic / fixed)
+              << std::endl;
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Time the bitboard solver against the generic dynamic programming
+// algorithm on 64-column grids with increasing amounts of rock.
+int bitboard_benchmark(gnomes::coordinate rows, size_t repeats) {
+
+  const gnomes::coordinate columns = 64;
+  const unsigned cells = rows * columns;
+
+  print_bar();
+  std::cout << "bitboard dynamic programming, rows=" << rows
+            << ", columns=" << columns << ", " << repeats << " repeats" << std::endl;
+
+  std::mt19937 gen;
+  for (unsigned rock_percent : {10, 30, 40, 50, 60}) {
+    gnomes::grid input = gnomes::grid::random(rows, columns, cells / 5,
+                                              (cells * rock_percent) / 100, gen);
+
+    size_t reachable = 0;
+    for (auto mask : gnomes::bitboard_reachable(input)) {
+      reachable += __builtin_popcountll(mask);
+    }
+
+    gnomes::solver_context context;
+    unsigned generic_gold = 0, bitboard_gold = 0;
+    Timer timer;
+    for (size_t r = 0; r < repeats; ++r) {
+      generic_gold += greedy_gnomes_dyn_prog(input, context).total_gold();
+    }
+    double generic = timer.elapsed();
+    timer.reset();
+    for (size_t r = 0; r < repeats; ++r) {
+      bitboard_gold += greedy_gnomes_dyn_prog_bitboard(input).total_gold();
+    }
+    double bitboard = timer.elapsed();
+    if (generic_gold != bitboard_gold) {
+      std::cerr << "rock=" << rock_percent << "% bitboard found " << bitboard_gold
+                << " gold, generic " << generic_gold << std::endl;
+      return 1;
+    }
+
+    std::cout << "rock=" << rock_percent << "%"
+              << " reachable cells=" << ((100.0 * reachable) / cells) << "%"
+              << " generic=" << generic << " seconds"
+              << " bitboard=" << bitboard << " seconds"
+              << " speedup=" << (generic / bitboard)
+              << std::endl;
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Report how much of the grid the live-region pre-pass lets the solvers
+// skip as rock gets denser, and time the dynamic programming (at size n)
+// and exhaustive search (at size exhaustive_n) with and without it. Each
+// line averages over count random grids with 20% gold.
+int live_region_benchmark(size_t n, size_t exhaustive_n, size_t count) {
+
+  print_bar();
+  std::cout << "live region pre-pass, n=" << n
+            << ", exhaustive n=" << exhaustive_n
+            << ", " << count << " grids per line" << std::endl;
+
+  std::mt19937 gen;
+  for (unsigned rock_percent : {10, 20, 30, 40, 50, 60}) {
+    auto make = [&](size_t size) {
+      gnomes::coordinate rows = size / 2, columns = size - rows;
+      unsigned cells = rows * columns;
+      return gnomes::grid::random(rows, columns, cells / 5,
+                                  (cells * rock_percent) / 100, gen);
+    };
+
+    double skipped = 0, prepass = 0, plain = 0, live = 0;
+    gnomes::solver_context context;
+    Timer timer;
+    for (size_t k = 0; k < count; ++k) {
+      gnomes::grid input = make(n);
+      timer.reset();
+      skipped += gnomes::find_live_region(input).skipped_fraction();
+      prepass += timer.elapsed();
+      timer.reset();
+      unsigned plain_gold = greedy_gnomes_dyn_prog(input, context).total_gold();
+      plain += timer.elapsed();
+      timer.reset();
+      unsigned live_gold = greedy_gnomes_dyn_prog_live(input, context).total_gold();
+      live += timer.elapsed();
+      if (plain_gold != live_gold) {
+        std::cerr << "rock=" << rock_percent << "% live dyn_prog found " << live_gold
+                  << " gold, plain " << plain_gold << std::endl;
+        return 1;
+      }
+    }
+
+    double exhaustive_skipped = 0, exhaustive_plain = 0, exhaustive_live = 0;
+    for (size_t k = 0; k < count; ++k) {
+      gnomes::grid input = make(exhaustive_n);
+      exhaustive_skipped += gnomes::find_live_region(input).skipped_fraction();
+      timer.reset();
+      auto plain_output = greedy_gnomes_exhaustive(input);
+      exhaustive_plain += timer.elapsed();
+      timer.reset();
+      auto live_output = greedy_gnomes_exhaustive_live(input);
+      exhaustive_live += timer.elapsed();
+      if (!(plain_output == live_output)) {
+        std::cerr << "rock=" << rock_percent << "% live exhaustive search path differs"
+                  << " from plain" << std::endl;
+        return 1;
+      }
+    }
+
+    std::cout << "rock=" << rock_percent << "%" << std::endl
+              << "  dyn_prog   skipped=" << ((100.0 * skipped) / count) << "%"
+              << " pre-pass=" << (prepass / count)
+              << " plain=" << (plain / count)
+              << " live=" << (live / count) << " seconds" << std::endl
+              << "  exhaustive skipped=" << ((100.0 * exhaustive_skipped) / count) << "%"
+              << " plain=" << (exhaustive_plain / count)
+              << " live=" << (exhaustive_live / count) << " seconds" << std::endl;
+  }
+
+  print_bar();
+  return 0;
+}
 
-  assert(n > 0);
+// Write a rows x columns grid with 20% gold and 10% rock to the named grid
+// file, then time opening it and solving it for gold straight from the
+// mapping, next to solving the in-memory grid. The file is left in place.
+int grid_file_benchmark(gnomes::coordinate rows, gnomes::coordinate columns,
+                        const std::string& filename) {
+
+  print_bar();
+  std::cout << "grid file, rows=" << rows << ", columns=" << columns
+            << ", file=" << filename << std::endl;
+
+  // grid::random shuffles every position, which is too slow at this size,
+  // so draw each cell independently instead.
+  std::mt19937 gen;
+  std::uniform_int_distribution<unsigned> percent(0, 99);
+  std::vector<gnomes::cell_kind> cells(rows * columns);
+  for (auto& cell : cells) {
+    unsigned p = percent(gen);
+    cell = (p < 20) ? gnomes::CELL_GOLD : ((p < 30) ? gnomes::CELL_ROCK : gnomes::CELL_EARTH);
+  }
+  cells[0] = gnomes::CELL_EARTH;
+  gnomes::grid input(rows, columns, std::move(cells));
+
+  Timer timer;
+  bool written = gnomes::write_grid_file(filename, input);
+  double write_time = timer.elapsed();
+  if (!written) {
+    std::cout << "could not write " << filename << std::endl;
+    return 1;
+  }
+
+  gnomes::mapped_grid_file file;
+  timer.reset();
+  bool opened = file.open(filename);
+  double open_time = timer.elapsed();
+  if (!opened) {
+    std::cout << "could not open " << filename << std::endl;
+    return 1;
+  }
+
+  timer.reset();
+  auto mapped = gnomes::greedy_gnomes_dyn_prog_gold(file.view());
+  double mapped_time = timer.elapsed();
+
+  timer.reset();
+  auto in_memory = gnomes::greedy_gnomes_dyn_prog_gold(input);
+  double in_memory_time = timer.elapsed();
+  if (mapped.total_gold != in_memory.total_gold) {
+    std::cout << "mapped file found " << mapped.total_gold << " gold, in memory "
+              << in_memory.total_gold << std::endl;
+    return 1;
+  }
+
+  const double megabytes = (sizeof(gnomes::grid_file_header) +
+                            (rows * gnomes::packed_grid_view::words_per_row(columns) *
+                             sizeof(uint64_t))) / 1e6;
+  std::cout << "file size=" << megabytes << " MB" << std::endl
+            << "write=" << write_time << " seconds" << std::endl
+            << "open=" << open_time << " seconds" << std::endl
+            << "solve mapped=" << mapped_time << " seconds"
+            << " (" << (megabytes / mapped_time) << " MB/s)" << std::endl
+            << "solve in memory=" << in_memory_time << " seconds" << std::endl
+            << "total gold=" << mapped.total_gold << std::endl;
+
+  print_bar();
+  return 0;
+}
+
+// Measure the throughput of parsing a rows x columns grid from text: into a
+// flat grid, streamed straight into the row solver, and with a naive loop
+// that reads one character at a time for comparison.
+int text_parse_benchmark(gnomes::coordinate rows, gnomes::coordinate columns) {
+
+  print_bar();
+  std::cout << "grid text parsing, rows=" << rows << ", columns=" << columns << std::endl;
+
+  std::mt19937 gen;
+  std::uniform_int_distribution<unsigned> percent(0, 99);
+  std::string text;
+  text.reserve(rows * (columns + 1));
+  for (gnomes::coordinate i = 0; i < rows; ++i) {
+    for (gnomes::coordinate j = 0; j < columns; ++j) {
+      unsigned p = percent(gen);
+      text += ((i == 0) && (j == 0)) ? '.' : ((p < 20) ? 'g' : ((p < 30) ? 'X' : '.'));
+    }
+    text += '\n';
+  }
+  const double megabytes = text.size() / 1e6;
+
+  Timer timer;
+  std::istringstream grid_in(text);
+  gnomes::grid parsed(1, 1);
+  bool ok = gnomes::read_grid_text(grid_in, parsed);
+  double grid_time = timer.elapsed();
+  if (!ok || (parsed.rows() != rows) || (parsed.columns() != columns)) {
+    std::cout << "could not parse the grid text" << std::endl;
+    return 1;
+  }
+
+  timer.reset();
+  std::istringstream stream_in(text);
+  gnomes::grid_text_reader reader(stream_in);
+  const gnomes::cell_kind* row = reader.next_row();
+  gnomes::dyn_prog_row_solver solver(reader.columns());
+  for (; row != nullptr; row = reader.next_row()) {
+    solver.add_row(row);
+  }
+  double stream_time = timer.elapsed();
+  if (reader.failed() || (solver.rows() != rows)) {
+    std::cout << "could not stream the grid text, " << solver.rows() << " rows read" << std::endl;
+    return 1;
+  }
+  if (solver.summary().total_gold != gnomes::greedy_gnomes_dyn_prog_gold(parsed).total_gold) {
+    std::cout << "streamed and parsed grids give different gold" << std::endl;
+    return 1;
+  }
+
+  timer.reset();
+  std::istringstream naive_in(text);
+  std::vector<gnomes::cell_kind> cells;
+  for (int c = naive_in.get(); c != std::char_traits<char>::eof(); c = naive_in.get()) {
+    if (c == 'g') {
+      cells.push_back(gnomes::CELL_GOLD);
+    } else if (c == 'X') {
+      cells.push_back(gnomes::CELL_ROCK);
+    } else if (c == '.') {
+      cells.push_back(gnomes::CELL_EARTH);
+    }
+  }
+  double naive_time = timer.elapsed();
+  if (cells.size() != (rows * columns)) {
+    std::cout << "naive loop read " << cells.size() << " cells" << std::endl;
+    return 1;
+  }
+
+  std::cout << "text size=" << megabytes << " MB" << std::endl
+            << "into grid=" << grid_time << " seconds"
+            << " (" << (megabytes / grid_time) << " MB/s)" << std::endl
+            << "streamed into row solver=" << stream_time << " seconds"
+            << " (" << (megabytes / stream_time) << " MB/s)" << std::endl
+            << "naive get() loop=" << naive_time << " seconds"
+            << " (" << (megabytes / naive_time) << " MB/s)" << std::endl;
+
+  print_bar();
+  return 0;
+}
+
+// Time generating an n x n grid with 20% gold and 10% rock, with
+// grid::random and with random_grid on 1, 2, 4, ... threads.
+int generator_benchmark(gnomes::coordinate n) {
+
+  print_bar();
+  std::cout << "random grid generation, rows=columns=" << n << std::endl;
+
+  Timer timer;
+  const unsigned cells = n * n;
+  std::mt19937 gen;
+  gnomes::grid shuffled = gnomes::grid::random(n, n, cells / 5, cells / 10, gen);
+  std::cout << "grid::random elapsed=" << timer.elapsed() << " seconds" << std::endl;
+
+  std::string reference;
+  for (size_t threads = 1; ; threads *= 2) {
+    threads = std::min(threads, ThreadPool::hardware_threads());
+    ThreadPool pool(threads);
+    timer.reset();
+    gnomes::grid sampled = gnomes::random_grid(n, n, 0.2, 0.1, 1, pool);
+    double elapsed = timer.elapsed();
+    std::cout << "random_grid threads=" << threads
+              << " elapsed=" << elapsed << " seconds" << std::endl;
+
+    // Every thread count must produce the same grid; compare the last rows.
+    std::string last_row(sampled.row_begin(n - 1), sampled.row_end(n - 1));
+    if (reference.empty()) {
+      reference = last_row;
+    }
+    if (reference != last_row) {
+      std::cout << "random_grid differs with " << threads << " threads" << std::endl;
+      return 1;
+    }
+
+    if (threads == ThreadPool::hardware_threads()) {
+      break;
+    }
+  }
+
+  print_bar();
+  return 0;
+}
+
+// Print the calling thread's solver stats, if they are compiled in.
+void print_solver_stats() {
+  if (gnomes::solver_stats::enabled) {
+    std::cout << "solver stats: ";
+    gnomes::solver_stats::current().print();
+  }
+}
+
+// Run every general-purpose solver once on a single grid of size n, and
+// print the grid, each solver's path and elapsed time, and the solver stats
+// of the instrumented exhaustive and dynamic programming solvers.
+int compare_benchmark(size_t n) {
 
   gnomes::coordinate rows = n / 2,
                      columns = n - rows;
@@ -46,28 +748,458 @@ int main() {
             << std::endl << std::endl;
 
   input.print();
+  if (!gnomes::solver_stats::enabled) {
+    std::cout << std::endl
+              << "(solver stats are off; build with -DGNOMES_ENABLE_STATS to see them)"
+              << std::endl;
+  }
 
   print_bar();
   std::cout << "exhaustive optimization" << std::endl;
   if (n > EXHAUSTIVE_SEARCH_MAX_N) {
     std::cout << std::endl << "(n too large, skipping exhaustive search)" << std::endl;
   } else {
+    gnomes::solver_stats::current().reset();
     timer.reset();
     auto exhaustive_output = greedy_gnomes_exhaustive(input);
     elapsed = timer.elapsed();
     exhaustive_output.print();
     std::cout << std::endl << "elapsed time=" << elapsed << " seconds" << std::endl;
+    print_solver_stats();
+  }
+
+  print_bar();
+  std::cout << "parallel exhaustive optimization" << std::endl;
+  if (n > EXHAUSTIVE_SEARCH_MAX_N) {
+    std::cout << std::endl << "(n too large, skipping exhaustive search)" << std::endl;
+  } else {
+    ThreadPool pool;
+    timer.reset();
+    auto parallel_output = greedy_gnomes_exhaustive_parallel(input, pool);
+    elapsed = timer.elapsed();
+    parallel_output.print();
+    std::cout << std::endl << "elapsed time=" << elapsed << " seconds"
+              << " threads=" << pool.size() << std::endl;
+  }
+
+  print_bar();
+  std::cout << "incremental exhaustive optimization" << std::endl;
+  if (n > EXHAUSTIVE_SEARCH_MAX_N) {
+    std::cout << std::endl << "(n too large, skipping exhaustive search)" << std::endl;
+  } else {
+    timer.reset();
+    auto incremental_output = greedy_gnomes_exhaustive_incremental(input);
+    elapsed = timer.elapsed();
+    incremental_output.print();
+    std::cout << std::endl << "elapsed time=" << elapsed << " seconds" << std::endl;
+  }
+
+  print_bar();
+  std::cout << "pruned exhaustive optimization" << std::endl;
+  if (n > PRUNED_SEARCH_MAX_N) {
+    std::cout << std::endl << "(n too large, skipping pruned search)" << std::endl;
+  } else {
+    timer.reset();
+    auto pruned_output = greedy_gnomes_exhaustive_pruned(input);
+    elapsed = timer.elapsed();
+    pruned_output.print();
+    std::cout << std::endl << "elapsed time=" << elapsed << " seconds" << std::endl;
   }
 
   print_bar();
   std::cout << "dynamic programming" << std::endl;
+  gnomes::solver_stats::current().reset();
   timer.reset();
   auto dyn_prog_output = greedy_gnomes_dyn_prog(input);
   elapsed = timer.elapsed();
   dyn_prog_output.print();
   std::cout << std::endl << "elapsed time=" << elapsed << " seconds" << std::endl;
+  print_solver_stats();
 
   print_bar();
 
   return 0;
 }
+
+// One solver in the benchmark sweep: how to run it, and the default sizes
+// to run it on. Sizes go from min_n to max_n, adding step each time, or
+// multiplying by factor when step is zero. Sizes above limit_n, which the
+// solver cannot handle in reasonable time or at all, are always skipped.
+// solve gets a thread pool that parallel solvers run on.
+struct sweep_solver {
+  std::string name;
+  size_t min_n, max_n, step;
+  double factor;
+  size_t limit_n;
+  std::function<unsigned(const gnomes::grid&, ThreadPool&)> solve;
+};
+
+// Measurements of one solver at one size. counters holds the hardware
+// counters and allocations per timed run, and the peak RSS and its growth
+// over all the timed runs.
+struct sweep_point {
+  size_t n;
+  gnomes::coordinate rows, columns;
+  double min, median, p95;
+  unsigned total_gold;
+  Measurement::Report counters;
+};
+
+// Print the counters of a sweep point as CSV fields or JSON members, with
+// empty fields or nulls for what is unavailable.
+void print_counters(std::ostream& out, const Measurement::Report& counters, bool json) {
+  for (int c = 0; c < Measurement::COUNTER_COUNT; ++c) {
+    out << ",";
+    if (json) {
+      out << " \"" << Measurement::counter_name(c) << "\": ";
+    }
+    if (counters.available[c]) {
+      out << counters.counts[c];
+    } else if (json) {
+      out << "null";
+    }
+  }
+  out << (json ? ", \"ipc\": " : ",");
+  if (counters.instructions_per_cycle() > 0) {
+    out << counters.instructions_per_cycle();
+  } else if (json) {
+    out << "null";
+  }
+  out << (json ? ", \"peak_rss_bytes\": " : ",");
+  if (counters.has_rss) {
+    out << counters.peak_rss_bytes;
+  } else if (json) {
+    out << "null";
+  }
+  out << (json ? ", \"rss_growth_bytes\": " : ",");
+  if (counters.has_rss) {
+    out << counters.rss_growth_bytes;
+  } else if (json) {
+    out << "null";
+  }
+  out << (json ? ", \"allocations\": " : ",") << counters.allocations;
+}
+
+// Print a fitted growth value, or the given text for a missing fit.
+void print_fit(std::ostream& out, double fit, const char* missing) {
+  if (std::isnan(fit)) {
+    out << missing;
+  } else {
+    out << fit;
+  }
+}
+
+// Sweep each solver over its range of sizes, timing warmup untimed runs and
+// then repeats timed runs per size on a random grid of rows=n/2 and
+// columns=n-n/2, with 20% gold and 10% rock from random_grid seeded by
+// seed+n. Reports the minimum, median and 95th percentile time per size,
+// the hardware counters and heap allocations per timed run along with the
+// peak RSS during the timed runs and how far it rose above the RSS before
+// them, and fits, over the medians, the exponent k of time ~ n^k and the
+// base b of time ~ b^n.
+//
+// Options are key=value words:
+//   solvers=NAME,NAME,...  solvers to run (default: all)
+//   min=N max=N            size range, overriding each solver's default
+//                          (but never its limit)
+//   step=N or factor=F     size increment, overriding each solver's default
+//   repeats=R warmup=W     timed and untimed runs per size (default 5 and 1)
+//   seed=S                 base random seed (default 1)
+//   format=table|csv|json  output format (default table)
+int sweep_benchmark(int argc, char* argv[]) {
+
+  std::vector<sweep_solver> solvers = {
+    {"exhaustive", 4, 22, 2, 0, EXHAUSTIVE_SEARCH_MAX_N,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_exhaustive(g).total_gold(); }},
+    {"exhaustive_incremental", 4, 24, 2, 0, EXHAUSTIVE_SEARCH_MAX_N,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_exhaustive_incremental(g).total_gold(); }},
+    {"exhaustive_parallel", 4, 24, 2, 0, EXHAUSTIVE_SEARCH_MAX_N,
+     [](const gnomes::grid& g, ThreadPool& pool) { return greedy_gnomes_exhaustive_parallel(g, pool).total_gold(); }},
+    {"exhaustive_live", 4, 24, 2, 0, EXHAUSTIVE_SEARCH_MAX_N,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_exhaustive_live(g).total_gold(); }},
+    {"exhaustive_pruned", 4, 36, 4, 0, PRUNED_SEARCH_MAX_N,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_exhaustive_pruned(g).total_gold(); }},
+    {"dyn_prog", 64, 4096, 0, 2, SIZE_MAX,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_dyn_prog(g).total_gold(); }},
+    {"dyn_prog_live", 64, 4096, 0, 2, SIZE_MAX,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_dyn_prog_live(g).total_gold(); }},
+    {"dyn_prog_gold", 64, 4096, 0, 2, SIZE_MAX,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_dyn_prog_gold(g).total_gold; }},
+    {"dyn_prog_linear_space", 64, 4096, 0, 2, SIZE_MAX,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_dyn_prog_linear_space(g).total_gold(); }},
+    {"dyn_prog_wavefront", 64, 4096, 0, 2, SIZE_MAX,
+     [](const gnomes::grid& g, ThreadPool& pool) { return greedy_gnomes_dyn_prog_wavefront(g, pool).total_gold(); }},
+    {"dyn_prog_bitboard", 16, 128, 0, 2, 128,
+     [](const gnomes::grid& g, ThreadPool&) { return greedy_gnomes_dyn_prog_bitboard(g).total_gold(); }},
+  };
+
+  std::string selected, format = "table";
+  size_t min_n = 0, max_n = 0, step = 0, repeats = 5, warmup = 1, seed = 1;
+  double factor = 0;
+  for (int i = 0; i < argc; ++i) {
+    std::string option = argv[i];
+    size_t equals = option.find('=');
+    std::string key = option.substr(0, equals),
+                value = (equals == std::string::npos) ? "" : option.substr(equals + 1);
+    if (key == "solvers") {
+      selected = "," + value + ",";
+    } else if (key == "min") {
+      min_n = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (key == "max") {
+      max_n = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (key == "step") {
+      step = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (key == "factor") {
+      factor = std::strtod(value.c_str(), nullptr);
+    } else if (key == "repeats") {
+      repeats = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (key == "warmup") {
+      warmup = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (key == "seed") {
+      seed = std::strtoul(value.c_str(), nullptr, 10);
+    } else if ((key == "format") && ((value == "table") || (value == "csv") || (value == "json"))) {
+      format = value;
+    } else {
+      std::cerr << "unknown sweep option " << option << std::endl;
+      return 1;
+    }
+  }
+  if ((repeats == 0) || (min_n == 1) || ((factor != 0) && (factor <= 1))) {
+    std::cerr << "repeats must be positive, min at least 2, and factor above 1" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::pair<const sweep_solver*, std::vector<sweep_point>>> results;
+  for (auto& solver : solvers) {
+    if (!selected.empty() && (selected.find("," + solver.name + ",") == std::string::npos)) {
+      continue;
+    }
+    size_t n = min_n ? min_n : solver.min_n,
+           last = max_n ? max_n : solver.max_n,
+           add = step ? step : (factor ? 0 : solver.step);
+    double multiply = factor ? factor : solver.factor;
+
+    std::vector<sweep_point> points;
+    last = std::min(last, solver.limit_n);
+    for (; n <= last; n = add ? (n + add) : std::max(n + 1, size_t(n * multiply))) {
+      gnomes::coordinate rows = n / 2, columns = n - rows;
+      gnomes::grid input = gnomes::random_grid(rows, columns, 0.2, 0.1, seed + n);
+
+      unsigned gold = 0;
+      {
+        ThreadPool pool;
+        for (size_t w = 0; w < warmup; ++w) {
+          gold = solver.solve(input, pool);
+        }
+      }
+      Samples samples;
+      Measurement measurement(AllocCounter::allocations);
+      {
+        // The counters only follow threads started after they open, and
+        // only add in a thread's counts when it exits, so the pool is
+        // started and joined inside the measurement. Starting it is not
+        // part of the runs.
+        ThreadPool pool;
+        measurement.reset();
+        for (size_t r = 0; r < repeats; ++r) {
+          Timer timer;
+          gold = solver.solve(input, pool);
+          samples.add(timer.elapsed());
+        }
+      }
+      Measurement::Report counters = measurement.report();
+      for (auto& count : counters.counts) {
+        count /= repeats;
+      }
+      counters.allocations /= repeats;
+
+      points.push_back(sweep_point{n, rows, columns, samples.min(), samples.median(),
+                                   samples.percentile(95), gold, counters});
+    }
+    results.emplace_back(&solver, points);
+  }
+
+  // Fit growth over the medians; a fit needs two sizes.
+  auto fits = [](const std::vector<sweep_point>& points) {
+    std::vector<double> sizes, seconds;
+    for (auto& point : points) {
+      sizes.push_back(point.n);
+      seconds.push_back(std::max(point.median, 1e-9));
+    }
+    if (sizes.size() < 2) {
+      return std::make_pair(std::nan(""), std::nan(""));
+    }
+    return std::make_pair(growth_exponent(sizes, seconds), growth_base(sizes, seconds));
+  };
+
+  if (format == "csv") {
+    std::cout << "solver,n,rows,columns,trials,min_seconds,median_seconds,p95_seconds,"
+              << "total_gold,growth_exponent,growth_base,";
+    for (int c = 0; c < Measurement::COUNTER_COUNT; ++c) {
+      std::cout << Measurement::counter_name(c) << ",";
+    }
+    std::cout << "ipc,peak_rss_bytes,rss_growth_bytes,allocations" << std::endl;
+    for (auto& result : results) {
+      auto fit = fits(result.second);
+      for (auto& point : result.second) {
+        std::cout << result.first->name << "," << point.n << "," << point.rows << ","
+                  << point.columns << "," << repeats << "," << point.min << ","
+                  << point.median << "," << point.p95 << "," << point.total_gold << ",";
+        print_fit(std::cout, fit.first, "");
+        std::cout << ",";
+        print_fit(std::cout, fit.second, "");
+        print_counters(std::cout, point.counters, false);
+        std::cout << std::endl;
+      }
+    }
+  } else if (format == "json") {
+    std::cout << "{\"repeats\": " << repeats << ", \"warmup\": " << warmup
+              << ", \"seed\": " << seed << ", \"solvers\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      auto fit = fits(results[i].second);
+      std::cout << (i ? "," : "") << std::endl
+                << "  {\"name\": \"" << results[i].first->name << "\", \"growth_exponent\": ";
+      print_fit(std::cout, fit.first, "null");
+      std::cout << ", \"growth_base\": ";
+      print_fit(std::cout, fit.second, "null");
+      std::cout << ", \"points\": [";
+      for (size_t j = 0; j < results[i].second.size(); ++j) {
+        auto& point = results[i].second[j];
+        std::cout << (j ? "," : "") << std::endl
+                  << "    {\"n\": " << point.n << ", \"rows\": " << point.rows
+                  << ", \"columns\": " << point.columns << ", \"min\": " << point.min
+                  << ", \"median\": " << point.median << ", \"p95\": " << point.p95
+                  << ", \"total_gold\": " << point.total_gold;
+        print_counters(std::cout, point.counters, true);
+        std::cout << "}";
+      }
+      std::cout << "]}";
+    }
+    std::cout << std::endl << "]}" << std::endl;
+  } else {
+    print_bar();
+    std::cout << "scaling sweep, " << warmup << " warm-up and " << repeats
+              << " timed runs per size" << std::endl;
+    for (auto& result : results) {
+      auto fit = fits(result.second);
+      print_bar();
+      std::cout << result.first->name << std::endl;
+      for (auto& point : result.second) {
+        std::cout << "n=" << point.n << " min=" << point.min << " median=" << point.median
+                  << " p95=" << point.p95 << " seconds, gold=" << point.total_gold << std::endl;
+        std::string counters = point.counters.summary();
+        std::cout << "  per run:" << counters.substr(counters.find(' ')) << std::endl;
+      }
+      std::cout << "time ~ n^";
+      print_fit(std::cout, fit.first, "?");
+      std::cout << ", time ~ ";
+      print_fit(std::cout, fit.second, "?");
+      std::cout << "^n" << std::endl;
+    }
+    print_bar();
+  }
+
+  return 0;
+}
+
+// Usage:
+//   gnomes_timing [sweep] [OPTION=VALUE]...  scaling sweep of every solver;
+//                                          see sweep_benchmark for options
+//   gnomes_timing compare [N]              run each solver once at size N
+//   gnomes_timing wavefront [N] [TILE]     wavefront thread scaling
+//   gnomes_timing kernels [COLUMNS]        SIMD row kernels vs. scalar loop
+//   gnomes_timing allocations [N]          heap allocations per candidate
+//   gnomes_timing batch [COUNT] [N]        batch solver throughput
+//   gnomes_timing context [COUNT] [N]      heap allocations with a context
+//   gnomes_timing incremental [N] [EDITS]  re-solving after single-cell edits
+//   gnomes_timing fixed [COUNT]            fixed-size solvers vs. generic
+//   gnomes_timing bitboard [ROWS] [REPEATS] bitboard solver on rocky maps
+//   gnomes_timing live [N] [EXHAUSTIVE_N] [COUNT]  cells skipped by pre-pass
+//   gnomes_timing file [ROWS] [COLUMNS] [FILE]      write, map, and solve a grid file
+//   gnomes_timing text [ROWS] [COLUMNS]    grid text parsing throughput
+//   gnomes_timing generate [N]             random grid generation speed
+int main(int argc, char* argv[]) {
+
+  std::string mode = (argc > 1) ? argv[1] : "";
+  if (mode == "wavefront") {
+    size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 8000;
+    gnomes::coordinate tile_size = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 256;
+    assert(n > 1);
+    assert(tile_size > 0);
+    return wavefront_scaling(n, tile_size);
+  }
+  if (mode == "kernels") {
+    gnomes::coordinate columns = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    assert(columns > 0);
+    return kernel_benchmark(columns);
+  }
+  if (mode == "allocations") {
+    size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+    assert(n > 1);
+    return allocation_benchmark(n);
+  }
+  if (mode == "batch") {
+    size_t count = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 10000,
+           n = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 40;
+    assert(n > 1);
+    return batch_benchmark(count, n);
+  }
+  if (mode == "context") {
+    size_t count = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 100,
+           n = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 20;
+    assert(count > 0);
+    assert(n > 1);
+    return context_benchmark(count, n);
+  }
+  if (mode == "incremental") {
+    size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000,
+           edits = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 200;
+    assert(n > 1);
+    return incremental_benchmark(n, edits);
+  }
+  if (mode == "fixed") {
+    size_t count = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    return fixed_size_benchmark(count);
+  }
+  if (mode == "bitboard") {
+    gnomes::coordinate rows = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    size_t repeats = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 20;
+    assert(rows > 1);
+    return bitboard_benchmark(rows, repeats);
+  }
+  if (mode == "live") {
+    size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    size_t exhaustive_n = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 20;
+    size_t count = (argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 10;
+    assert((n > 1) && (exhaustive_n > 1) && (exhaustive_n <= EXHAUSTIVE_SEARCH_MAX_N));
+    return live_region_benchmark(n, exhaustive_n, count);
+  }
+  if (mode == "file") {
+    gnomes::coordinate rows = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 8000;
+    gnomes::coordinate columns = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 8000;
+    std::string filename = (argc > 4) ? argv[4] : "gnomes_timing.grid";
+    assert((rows > 0) && (columns > 0));
+    return grid_file_benchmark(rows, columns, filename);
+  }
+  if (mode == "text") {
+    gnomes::coordinate rows = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    gnomes::coordinate columns = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 5000;
+    assert((rows > 0) && (columns > 0));
+    return text_parse_benchmark(rows, columns);
+  }
+  if (mode == "generate") {
+    gnomes::coordinate n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 4000;
+    assert(n > 1);
+    return generator_benchmark(n);
+  }
+  if (mode == "compare") {
+    size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 15;
+    assert(n > 1);
+    return compare_benchmark(n);
+  }
+  if (mode == "sweep") {
+    return sweep_benchmark(argc - 2, argv + 2);
+  }
+
+  return sweep_benchmark(argc - 1, argv + 1);
+}
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <random>
 #include <string>
@@ -21,28 +22,51 @@ namespace gnomes {
   // Type for a row or column number.
   using coordinate = size_t;
 
-  // Type for one element of the map grid.
-  enum cell_kind { CELL_EARTH, CELL_ROCK, CELL_GOLD };
+  // Type for one element of the map grid. The underlying type is one byte so
+  // that a grid row is a dense array of cells.
+  enum cell_kind : uint8_t { CELL_EARTH, CELL_ROCK, CELL_GOLD };
 
   // Type for a rectangular grid representing the map.
+  //
+  // Cells are stored contiguously in row-major order, so a whole row can be
+  // scanned through the raw pointers returned by row_begin() and row_end()
+  // without going through the bounds assertions in get().
   class grid {
   private:
-    std::vector<std::vector<cell_kind>> cells_;
+    coordinate rows_, columns_;
+    std::vector<cell_kind> cells_;
+
+    // Return the index of the given row and column in cells_.
+    size_t index(coordinate row, coordinate column) const {
+      return (row * columns_) + column;
+    }
 
   public:
 
     // Create a grid with the given number of rows and columns, all initialized
     // to hold CELL_EARTH.
     grid(coordinate rows, coordinate columns)
-    : cells_(rows, std::vector<cell_kind>(columns, CELL_EARTH)) {
+    : rows_(rows), columns_(columns), cells_(rows * columns, CELL_EARTH) {
+
+      assert(rows > 0);
+      assert(columns > 0);
+    }
+
+    // Create a grid with the given number of rows and columns, taking its
+    // cells from the given row-major vector, which must hold exactly
+    // rows*columns cells. (0, 0) must be CELL_EARTH.
+    grid(coordinate rows, coordinate columns, std::vector<cell_kind>&& cells)
+    : rows_(rows), columns_(columns), cells_(std::move(cells)) {
 
       assert(rows > 0);
       assert(columns > 0);
+      assert(cells_.size() == (rows * columns));
+      assert(cells_.front() == CELL_EARTH);
     }
 
     // Accessors.
-    coordinate rows() const { return cells_.size(); }
-    coordinate columns() const { return cells_.front().size(); }
+    coordinate rows() const { return rows_; }
+    coordinate columns() const { return columns_; }
 
     // Test whether the given value is a valid row or column number.
     bool is_row(coordinate row) const { return row < rows(); }
@@ -54,7 +78,7 @@ namespace gnomes {
     // Return the cell at the given row and column.
     cell_kind get(coordinate row, coordinate column) const {
       assert(is_row_column(row, column));
-      return cells_[row][column];
+      return cells_[index(row, column)];
     }
 
     // Set the contents of the cell at the given row and column.
@@ -66,7 +90,7 @@ namespace gnomes {
         assert(kind == CELL_EARTH);
       }
 
-      cells_[row][column] = kind;
+      cells_[index(row, column)] = kind;
     }
 
     // Return true if it is valid to step into the given row and column.
@@ -74,7 +98,17 @@ namespace gnomes {
     // that cell is not CELL_ROCK.
     bool may_step(coordinate row, coordinate column) const {
       return (is_row_column(row, column) &&
-              (cells_[row][column] != CELL_ROCK));
+              (cells_[index(row, column)] != CELL_ROCK));
+    }
+
+    // Return pointers to the first cell, and one past the last cell, of the
+    // given row. The row holds exactly columns() cells.
+    const cell_kind* row_begin(coordinate row) const {
+      assert(is_row(row));
+      return cells_.data() + index(row, 0);
+    }
+    const cell_kind* row_end(coordinate row) const {
+      return row_begin(row) + columns_;
     }
 
     // Return strings corresponding to lines of text in a human-readable
@@ -163,6 +197,197 @@ namespace gnomes {
     }
   };
 
+  // A grid whose gold cells each hold a value, rather than all counting as
+  // one. The layout of earth, rock, and gold is an ordinary grid, which paths
+  // on this grid refer to; the values are stored alongside it in row-major
+  // order, and are zero for earth and rock.
+  template <typename Value>
+  class weighted_grid {
+  private:
+    grid terrain_;
+    std::vector<Value> values_;
+
+  public:
+
+    using value_type = Value;
+
+    // Create a grid with the given number of rows and columns, all initialized
+    // to hold CELL_EARTH.
+    weighted_grid(coordinate rows, coordinate columns)
+    : terrain_(rows, columns), values_(rows * columns, 0) { }
+
+    // Create a weighted copy of the given grid in which every gold cell is
+    // worth one.
+    explicit weighted_grid(const grid& terrain)
+    : terrain_(terrain), values_(terrain.rows() * terrain.columns(), 0) {
+
+      for (coordinate row = 0; row < rows(); ++row) {
+        const cell_kind* cells = terrain.row_begin(row);
+        for (coordinate column = 0; column < columns(); ++column) {
+          values_[(row * columns()) + column] = (cells[column] == CELL_GOLD);
+        }
+      }
+    }
+
+    // Accessors.
+    const grid& terrain() const { return terrain_; }
+    coordinate rows() const { return terrain_.rows(); }
+    coordinate columns() const { return terrain_.columns(); }
+
+    // Return the value of the cell at the given row and column.
+    Value value(coordinate row, coordinate column) const {
+      assert(terrain_.is_row_column(row, column));
+      return values_[(row * columns()) + column];
+    }
+
+    // Return the values of the given row, which holds columns() values.
+    const Value* row_values(coordinate row) const {
+      assert(terrain_.is_row(row));
+      return values_.data() + (row * columns());
+    }
+
+    // Set the cell at the given row and column, with the same rules as
+    // grid::set. value is only kept for CELL_GOLD, and must be positive.
+    void set(coordinate row, coordinate column, cell_kind kind, Value value = 1) {
+      terrain_.set(row, column, kind);
+      if (kind == CELL_GOLD) {
+        assert(value > 0);
+        values_[(row * columns()) + column] = value;
+      } else {
+        values_[(row * columns()) + column] = 0;
+      }
+    }
+  };
+
+  // A read-only view of a grid whose cells are packed two bits per cell, 32
+  // cells per 64-bit word, with cell c of a row in bits 2*(c%32) and up of
+  // word c/32. Every row starts on a word boundary, so it occupies
+  // words_per_row() consecutive words and unused high bits are zero.
+  //
+  // The view does not own its words; packed_grid below is the owning
+  // version, and the words may also come from a memory-mapped file.
+  class packed_grid_view {
+  private:
+    coordinate rows_, columns_;
+    const uint64_t* words_;
+
+  public:
+
+    // Number of cells stored in one word.
+    static const coordinate CELLS_PER_WORD = 32;
+
+    // Return the number of words needed to hold one row of the given width.
+    static size_t words_per_row(coordinate columns) {
+      return (columns + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    }
+
+    // Create a view of rows*words_per_row(columns) words starting at words.
+    packed_grid_view(coordinate rows, coordinate columns, const uint64_t* words)
+    : rows_(rows), columns_(columns), words_(words) {
+
+      assert(rows > 0);
+      assert(columns > 0);
+      assert(words != nullptr);
+    }
+
+    // Accessors.
+    coordinate rows() const { return rows_; }
+    coordinate columns() const { return columns_; }
+    size_t words_per_row() const { return words_per_row(columns_); }
+
+    // Test whether the given value is a valid row or column number.
+    bool is_row(coordinate row) const { return row < rows(); }
+    bool is_column(coordinate column) const { return column < columns(); }
+    bool is_row_column(coordinate row, coordinate column) const {
+      return is_row(row) && is_column(column);
+    }
+
+    // Return the packed words of the given row.
+    const uint64_t* row_words(coordinate row) const {
+      assert(is_row(row));
+      return words_ + (row * words_per_row());
+    }
+
+    // Return the cell at the given row and column.
+    cell_kind get(coordinate row, coordinate column) const {
+      assert(is_row_column(row, column));
+      uint64_t word = row_words(row)[column / CELLS_PER_WORD];
+      return cell_kind((word >> (2 * (column % CELLS_PER_WORD))) & 3);
+    }
+
+    // Return true if it is valid to step into the given row and column.
+    bool may_step(coordinate row, coordinate column) const {
+      return is_row_column(row, column) && (get(row, column) != CELL_ROCK);
+    }
+
+    // Decode the given row into out, which must have room for columns()
+    // cells.
+    void unpack_row(coordinate row, cell_kind* out) const {
+      const uint64_t* words = row_words(row);
+      for (coordinate column = 0; column < columns_; column += CELLS_PER_WORD) {
+        uint64_t word = *words++;
+        coordinate count = std::min(coordinate(CELLS_PER_WORD), columns_ - column);
+        for (coordinate i = 0; i < count; ++i) {
+          out[column + i] = cell_kind(word & 3);
+          word >>= 2;
+        }
+      }
+    }
+
+    // Return an unpacked copy of the grid.
+    grid unpack() const {
+      std::vector<cell_kind> cells(rows_ * columns_);
+      for (coordinate row = 0; row < rows_; ++row) {
+        unpack_row(row, cells.data() + (row * columns_));
+      }
+      return grid(rows_, columns_, std::move(cells));
+    }
+  };
+
+  // A grid packed two bits per cell, which owns its storage. This uses
+  // one quarter of the memory of grid, at the price of some shifting and
+  // masking on every access.
+  class packed_grid {
+  private:
+    coordinate rows_, columns_;
+    std::vector<uint64_t> words_;
+
+  public:
+
+    // Create a packed copy of the given grid.
+    packed_grid(const grid& source)
+    : rows_(source.rows()),
+      columns_(source.columns()),
+      words_(source.rows() * packed_grid_view::words_per_row(source.columns()), 0) {
+
+      auto words_per_row = packed_grid_view::words_per_row(columns_);
+      for (coordinate row = 0; row < rows_; ++row) {
+        uint64_t* words = words_.data() + (row * words_per_row);
+        const cell_kind* cells = source.row_begin(row);
+        for (coordinate column = 0; column < columns_; ++column) {
+          words[column / packed_grid_view::CELLS_PER_WORD] |=
+            uint64_t(cells[column]) << (2 * (column % packed_grid_view::CELLS_PER_WORD));
+        }
+      }
+    }
+
+    // Accessors.
+    coordinate rows() const { return rows_; }
+    coordinate columns() const { return columns_; }
+    const std::vector<uint64_t>& words() const { return words_; }
+
+    // Return a read-only view of this grid, which remains valid as long as
+    // this object is alive.
+    packed_grid_view view() const {
+      return packed_grid_view(rows_, columns_, words_.data());
+    }
+
+    // Return the cell at the given row and column.
+    cell_kind get(coordinate row, coordinate column) const {
+      return view().get(row, column);
+    }
+  };
+
   // Type for a legal step direction; starting at (0, 0) counts as a step.
   enum step_direction {
     STEP_DIRECTION_START,
@@ -220,25 +445,33 @@ namespace gnomes {
   // This class tracks the ending position, and total gold, of the path, in order
   // to make it easier to compare candidate solutions in the exhaustive search
   // algorithm.
+  //
+  // The steps after STEP_DIRECTION_START are stored one bit each (1 for
+  // right, 0 for down) in an array of 64-bit words, so a path costs about
+  // (rows+columns)/8 bytes and two paths compare in O(words) time.
   class path {
   private:
     const grid* setting_;
-    std::vector<step> steps_;
+    std::vector<uint64_t> moves_;
+    size_t move_count_;
     coordinate final_row_, final_column_;
     unsigned total_gold_;
 
     // Helper function to initialize all data members, called by the two
     // constructors below.
     void initialize(const grid& setting) {
-      assert(steps_.empty());
+      assert(moves_.empty());
       setting_ = &setting;
-      steps_.emplace_back(STEP_DIRECTION_START);
+      move_count_ = 0;
       final_row_ = final_column_ = 0;
       total_gold_ = 0;
     }
 
   public:
 
+    // Number of moves stored in one word.
+    static const size_t MOVES_PER_WORD = 64;
+
     // Create an empty path, containing only one STEP_DIRECTION_START step
     // and no other steps.
     path(const grid& setting) { initialize(setting); }
@@ -249,21 +482,61 @@ namespace gnomes {
     // by the algorithms.
     path(const grid& setting, const std::vector<step_direction>& steps_after_start) {
       initialize(setting);
+      moves_.reserve((steps_after_start.size() + MOVES_PER_WORD - 1) / MOVES_PER_WORD);
       for (auto& step : steps_after_start) {
         assert(is_step_valid(step));
         add_step(step);
       }
     }
 
+    // Make this an empty path on the given grid again, keeping the memory
+    // already allocated for its moves, and reserving room for the longest
+    // path the grid allows.
+    void reset(const grid& setting) {
+      moves_.clear();
+      moves_.reserve((setting.rows() + setting.columns() - 2 + MOVES_PER_WORD - 1) /
+                     MOVES_PER_WORD);
+      initialize(setting);
+    }
+
     // Accessors.
     const grid& setting() const { return *setting_; }
-    const std::vector<step>& steps() const { return steps_; }
     coordinate final_row() const { return final_row_; }
     coordinate final_column() const { return final_column_; }
     unsigned total_gold() const { return total_gold_; }
 
+    // Return the packed moves; bit k%64 of word k/64 is 1 when step k+1
+    // moves right. Bits past the last move are zero.
+    const std::vector<uint64_t>& moves() const { return moves_; }
+
+    // Return the number of steps, counting STEP_DIRECTION_START.
+    size_t step_count() const { return move_count_ + 1; }
+
+    // Return the direction of the given step; step 0 is STEP_DIRECTION_START.
+    step_direction direction(size_t index) const {
+      assert(index < step_count());
+      if (index == 0) {
+        return STEP_DIRECTION_START;
+      }
+      --index;
+      return ((moves_[index / MOVES_PER_WORD] >> (index % MOVES_PER_WORD)) & 1)
+             ? STEP_DIRECTION_RIGHT
+             : STEP_DIRECTION_DOWN;
+    }
+
+    // Return all the steps, starting with STEP_DIRECTION_START. This unpacks
+    // the moves into a new vector.
+    std::vector<step> steps() const {
+      std::vector<step> result;
+      result.reserve(step_count());
+      for (size_t i = 0; i < step_count(); ++i) {
+        result.emplace_back(direction(i));
+      }
+      return result;
+    }
+
     // Return the last step in the path.
-    const step& last_step() const { return steps_.back(); }
+    step last_step() const { return step(direction(move_count_)); }
 
     // Return the row/column number that we would be in if we took one more step
     // in the given direction.
@@ -289,7 +562,13 @@ namespace gnomes {
 
       assert(is_step_valid(dir));
 
-      steps_.emplace_back(dir);
+      if ((move_count_ % MOVES_PER_WORD) == 0) {
+        moves_.push_back(0);
+      }
+      if (dir == STEP_DIRECTION_RIGHT) {
+        moves_.back() |= uint64_t(1) << (move_count_ % MOVES_PER_WORD);
+      }
+      ++move_count_;
 
       // Update final row, column, and total gold.
       final_row_ = row_after(dir);
@@ -306,8 +585,9 @@ namespace gnomes {
       auto lines = setting_->printable();
 
       coordinate row = 0, column = 0;
-      for (auto& s : steps_) {
+      for (size_t i = 0; i < step_count(); ++i) {
 
+        step s(direction(i));
         row += s.delta_row();
         column += s.delta_column();
 
@@ -329,14 +609,15 @@ namespace gnomes {
       for (auto& line : printable()) {
         std::cout << line << std::endl;
       }
-      std::cout << "steps=" << steps_.size()
+      std::cout << "steps=" << step_count()
                 << " gold=" << total_gold_
                 << std::endl;
     }
 
-    // Equality operator, for unit testing.
+    // Equality operator, for unit testing. Two paths are equal when they
+    // take the same steps.
     bool operator==(const path& o) const {
-      return std::equal(steps_.begin(), steps_.end(), o.steps_.begin());
+      return (move_count_ == o.move_count_) && (moves_ == o.moves_);
     }
 
   };
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// thread_pool.hpp
+//
+// A fixed-size pool of worker threads for data-parallel loops.
+//
+// This class depends only on the C++11 STL.
+//
+// How to use:
+//
+//    ThreadPool pool(4); // the calling thread plus 3 workers
+//    pool.parallel_for(count, [&](size_t i) {
+//      // process item i; items run concurrently, in no particular order
+//    });
+//    // parallel_for returns once every item has been processed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wake, _done;
+  const std::function<void(size_t)>* _body;
+  size_t _count;
+  std::atomic<size_t> _next;
+  size_t _generation, _busy;
+  bool _stop;
+
+  // Claim and process items of the current loop until none are left.
+  void drain() {
+    for (size_t i = _next++; i < _count; i = _next++) {
+      (*_body)(i);
+    }
+  }
+
+  // Body of each worker thread.
+  void work() {
+    size_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [&]() { return _stop || (_generation != seen); });
+        if (_stop) {
+          return;
+        }
+        seen = _generation;
+      }
+      drain();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_busy == 0) {
+          _done.notify_one();
+        }
+      }
+    }
+  }
+
+public:
+
+  // Return the number of hardware threads, or 1 if that is unknown.
+  static size_t hardware_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Create a pool that runs loops on the given number of threads, counting
+  // the thread that calls parallel_for. threads must be positive.
+  ThreadPool(size_t threads = hardware_threads())
+  : _body(nullptr), _count(0), _next(0), _generation(0), _busy(0), _stop(false) {
+
+    assert(threads > 0);
+    for (size_t i = 1; i < threads; ++i) {
+      _workers.emplace_back([this]() { work(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+  }
+
+  // Return the number of threads that run each loop.
+  size_t size() const { return _workers.size() + 1; }
+
+  // Call body(i) for every i in [0, count), spread over the pool's threads,
+  // and return when all calls have finished. Must not be called from inside
+  // body.
+  void parallel_for(size_t count, const std::function<void(size_t)>& body) {
+
+    if (_workers.empty() || (count <= 1)) {
+      for (size_t i = 0; i < count; ++i) {
+        body(i);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _body = &body;
+      _count = count;
+      _next = 0;
+      _busy = _workers.size();
+      ++_generation;
+    }
+    _wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&]() { return _busy == 0; });
+    _body = nullptr;
+  }
+};
@@ -1,13 +1,24 @@
 ///////////////////////////////////////////////////////////////////////////////
 // timer.hh
 //
-// Timer class for code timing.
+// Timer class for code timing, and Measurement class for timing plus
+// hardware and memory counters.
 //
-// This class depends only on the C++11 STL so it ought to be
+// Timer depends only on the C++11 STL so it ought to be
 // portable. It uses the std::clock() function which is precise to
 // platform-dependent fractions of a second, as specified by
 // CLOCKS_PER_SEC.
 //
+// Measurement adds CPU cycles, instructions, cache misses and branch
+// misses from Linux perf_event_open, the peak resident set size during the
+// measurement, and optionally a heap allocation count. Counters that the platform, kernel
+// or permissions (see /proc/sys/kernel/perf_event_paranoid) do not allow
+// are reported as unavailable, and everything else still works. The
+// hardware counters cover the creating thread and the threads it starts
+// afterwards, whose counts are only added once they exit, so a thread pool
+// must be started and joined between creating the Measurement and calling
+// report().
+//
 // How to use:
 //
 //    // do slow initialization before creating a Timer
@@ -16,12 +27,29 @@
 //    double elapsed = timer.elapsed();
 //    cout << "Elapsed time in seconds: " << elapsed << endl;
 //
+//    Measurement measurement(AllocCounter::allocations); // or no argument
+//    // run the code you want measured
+//    auto report = measurement.report();
+//    cout << report.summary() << endl;
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 #pragma once
 
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 class Timer {
 private:
@@ -48,3 +76,221 @@ public:
     return time_span.count();
   }
 };
+
+class Measurement {
+public:
+
+  // Hardware counters, in the order of Report::counts.
+  enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT };
+
+  // Return a short name for the given counter.
+  static const char* counter_name(int counter) {
+    static const char* names[COUNTER_COUNT] = {
+      "cycles", "instructions", "cache_misses", "branch_misses"
+    };
+    assert((counter >= 0) && (counter < COUNTER_COUNT));
+    return names[counter];
+  }
+
+  // Everything measured since the Measurement was created or reset.
+  struct Report {
+    double seconds;
+    // counts[c] is only meaningful when available[c].
+    bool available[COUNTER_COUNT];
+    uint64_t counts[COUNTER_COUNT];
+    // The process's peak resident set size since the reset, and how far it
+    // rose above the resident set size at the reset, when has_rss. This is
+    // memory the measured code touched, not memory it allocated: pages that
+    // stayed resident from before the reset are not counted again.
+    bool has_rss;
+    size_t peak_rss_bytes, rss_growth_bytes;
+    // Heap allocations, when an allocation counter was given.
+    bool has_allocations;
+    size_t allocations;
+
+    // Return instructions per cycle, or 0 if either is unavailable.
+    double instructions_per_cycle() const {
+      return (available[CYCLES] && available[INSTRUCTIONS] && (counts[CYCLES] > 0))
+             ? (double(counts[INSTRUCTIONS]) / counts[CYCLES]) : 0;
+    }
+
+    // Return the report as name=value words, leaving out what is
+    // unavailable.
+    std::string summary() const {
+      std::ostringstream out;
+      out << "seconds=" << seconds;
+      bool any_counter = false;
+      for (int c = 0; c < COUNTER_COUNT; ++c) {
+        if (available[c]) {
+          out << " " << counter_name(c) << "=" << counts[c];
+          any_counter = true;
+        }
+      }
+      if (instructions_per_cycle() > 0) {
+        out << " ipc=" << instructions_per_cycle();
+      }
+      if (!any_counter) {
+        out << " (hardware counters unavailable)";
+      }
+      if (has_rss) {
+        out << " peak_rss_mb=" << (peak_rss_bytes / 1e6)
+            << " rss_growth_mb=" << (rss_growth_bytes / 1e6);
+      }
+      if (has_allocations) {
+        out << " allocations=" << allocations;
+      }
+      return out.str();
+    }
+  };
+
+private:
+  Timer _timer;
+  size_t (*_allocation_count)();
+  size_t _allocations_start;
+  int _fds[COUNTER_COUNT];
+  // Raw value, time enabled, and time running of each counter at reset.
+  uint64_t _start[COUNTER_COUNT][3];
+  // Whether the peak resident set size was reset, and the resident set
+  // size at reset.
+  bool _rss_reset;
+  size_t _rss_start;
+
+  // Return the given field of /proc/self/status, such as "VmRSS", in bytes,
+  // or 0 if it cannot be read.
+  static size_t status_bytes(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      if (line.compare(0, field.size() + 1, field + ":") == 0) {
+        return size_t(std::strtoull(line.c_str() + field.size() + 1, nullptr, 10)) * 1024;
+      }
+    }
+    return 0;
+  }
+
+  // Reset the process's peak resident set size to its current resident set
+  // size, returning false if the kernel does not allow it (before Linux 4.0,
+  // or on other platforms).
+  static bool reset_peak_rss() {
+#ifdef __linux__
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5" << std::flush;
+    return bool(clear_refs);
+#else
+    return false;
+#endif
+  }
+
+  // Read the raw value, time enabled, and time running of counter c.
+  bool read_counter(int c, uint64_t values[3]) const {
+#ifdef __linux__
+    return (_fds[c] >= 0) &&
+           (::read(_fds[c], values, 3 * sizeof(uint64_t)) == ssize_t(3 * sizeof(uint64_t)));
+#else
+    (void) c;
+    (void) values;
+    return false;
+#endif
+  }
+
+  // Open counter c for this thread and the threads it starts from now on,
+  // leaving its descriptor at -1 on failure.
+  void open_counter(int c) {
+    _fds[c] = -1;
+#ifdef __linux__
+    static const uint64_t configs[COUNTER_COUNT] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[c];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    _fds[c] = int(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+public:
+
+  // Start measuring. allocation_count, if given, returns the number of heap
+  // allocations made so far, such as AllocCounter::allocations.
+  Measurement(size_t (*allocation_count)() = nullptr)
+  : _allocation_count(allocation_count) {
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+      open_counter(c);
+    }
+    reset();
+  }
+
+  Measurement(const Measurement&) = delete;
+  Measurement& operator=(const Measurement&) = delete;
+
+  ~Measurement() {
+#ifdef __linux__
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+      if (_fds[c] >= 0) {
+        ::close(_fds[c]);
+      }
+    }
+#endif
+  }
+
+  // Return true if any hardware counter could be opened.
+  bool has_counters() const {
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+      if (_fds[c] >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Restart the measurement. This resets the peak resident set size of the
+  // whole process, so a Measurement that was reset while another is running
+  // leaves the other's peak too low.
+  void reset() {
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+      if (!read_counter(c, _start[c])) {
+        _start[c][0] = _start[c][1] = _start[c][2] = 0;
+      }
+    }
+    _allocations_start = _allocation_count ? _allocation_count() : 0;
+    _rss_reset = reset_peak_rss();
+    _rss_start = _rss_reset ? status_bytes("VmRSS") : 0;
+    _timer.reset();
+  }
+
+  // Return what has been measured since the last reset. The counters keep
+  // running. When the kernel had to share a counter with other events, its
+  // count is scaled up by the fraction of time it was running.
+  Report report() const {
+    Report result;
+    result.seconds = _timer.elapsed();
+
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+      uint64_t now[3];
+      result.available[c] = read_counter(c, now) && (now[2] > _start[c][2]);
+      result.counts[c] = 0;
+      if (result.available[c]) {
+        double value = double(now[0] - _start[c][0]),
+               enabled = double(now[1] - _start[c][1]),
+               running = double(now[2] - _start[c][2]);
+        result.counts[c] = uint64_t(value * (enabled / running));
+      }
+    }
+
+    result.peak_rss_bytes = _rss_reset ? status_bytes("VmHWM") : 0;
+    result.has_rss = _rss_reset && (_rss_start > 0) && (result.peak_rss_bytes > 0);
+    result.rss_growth_bytes = (result.has_rss && (result.peak_rss_bytes > _rss_start))
+                              ? (result.peak_rss_bytes - _rss_start) : 0;
+
+    result.has_allocations = (_allocation_count != nullptr);
+    result.allocations = _allocation_count ? (_allocation_count() - _allocations_start) : 0;
+    return result;
+  }
+};